@@ -16,7 +16,7 @@
 #include "gtfs2graph/graph/BuildGraph.h"
 #include "gtfs2graph/graph/EdgePL.h"
 #include "gtfs2graph/graph/NodePL.h"
-#include "util/geo/output/GeoGraphJsonOutput.h"
+#include "shared/output/GeoGraphJsonWriter.h"
 #include "util/log/Log.h"
 
 using namespace gtfs2graph;
@@ -54,8 +54,9 @@ int main(int argc, char** argv) {
 
     b.simplify(&g);
 
-    util::geo::output::GeoGraphJsonOutput out;
-    out.printLatLng(g, std::cout);
+    shared::output::GeoGraphJsonWriter out(&std::cout, cfg.outputPrecision);
+    out.printLatLng(g);
+    out.flush();
   }
 
   return 0;
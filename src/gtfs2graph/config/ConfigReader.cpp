@@ -62,7 +62,10 @@ void ConfigReader::help(const char* bin) const {
       << "  funicular, coach} or as GTFS mot codes\n"
       << std::setw(36) << "  -p [ --prune-threshold ] arg (=0)"
       << "Threshold for pruning of seldomly occuring\n"
-      << std::setw(36) << " " << "  lines, between 0 and 1\n";
+      << std::setw(36) << " " << "  lines, between 0 and 1\n"
+      << std::setw(36) << "  --precision arg (=-1)"
+      << "Decimal places of output coordinates, -1 for\n"
+      << std::setw(36) << " " << "  default formatting\n";
 }
 
 // _____________________________________________________________________________
@@ -74,6 +77,7 @@ void ConfigReader::read(Config* cfg, int argc, char** argv) const {
                          {"help", no_argument, 0, 'h'},
                          {"mots", required_argument, 0, 'm'},
                          {"prune-threshold", required_argument, 0, 'p'},
+                         {"precision", required_argument, 0, 1},
                          {0, 0, 0, 0}};
 
   int c;
@@ -91,6 +95,9 @@ void ConfigReader::read(Config* cfg, int argc, char** argv) const {
       case 'p':
         pruneThreshold = atof(optarg);
         break;
+      case 1:
+        cfg->outputPrecision = atoi(optarg);
+        break;
       case ':':
         std::cerr << argv[optind - 1];
         std::cerr << " requires an argument" << std::endl;
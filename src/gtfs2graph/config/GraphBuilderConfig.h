@@ -16,6 +16,8 @@ struct Config {
 
   double pruneThreshold;
 
+  int outputPrecision = -1;
+
   std::set<ad::cppgtfs::gtfs::flat::Route::TYPE> useMots;
 };
 
@@ -13,10 +13,10 @@
 #include "loom/optim/CombOptimizer.h"
 #include "loom/optim/GreedyOptimizer.h"
 #include "loom/optim/ILPEdgeOrderOptimizer.h"
+#include "shared/output/GeoGraphJsonWriter.h"
 #include "shared/rendergraph/Penalties.h"
 #include "shared/rendergraph/RenderGraph.h"
 #include "util/geo/PolyLine.h"
-#include "util/geo/output/GeoGraphJsonOutput.h"
 #include "util/log/Log.h"
 
 using namespace loom;
@@ -102,8 +102,6 @@ int main(int argc, char** argv) {
     exit(1);
   }
 
-  util::geo::output::GeoGraphJsonOutput out;
-
   if (cfg.writeStats) {
     util::json::Dict jsonStats = {
         {"statistics",
@@ -142,9 +140,14 @@ int main(int argc, char** argv) {
              {"best_num_separations", stats.separations},
              {"line_graph_simplification_time", stats.simplificationTime},
              {"best_score", stats.score}}}};
-    out.printLatLng(g, std::cout, jsonStats);
+    shared::output::GeoGraphJsonWriter out(&std::cout, cfg.outputPrecision,
+                                           jsonStats);
+    out.printLatLng(g);
+    out.flush();
   } else {
-    out.printLatLng(g, std::cout);
+    shared::output::GeoGraphJsonWriter out(&std::cout, cfg.outputPrecision);
+    out.printLatLng(g);
+    out.flush();
   }
 
   return (0);
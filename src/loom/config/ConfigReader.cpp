@@ -68,6 +68,10 @@ void ConfigReader::help(const char* bin) const {
             << "Print stats to stdout\n"
             << std::setw(41) << "  --write-stats"
             << "Write stats to output\n"
+            << std::setw(41) << "  --precision arg (=-1)"
+            << "Decimal places of output coordinates, -1 for\n"
+            << std::setw(41) << " "
+            << " default formatting\n"
             << std::setw(41) << "  --ilp-solver arg (=gurobi)"
             << "Preferred ILP solver, either glpk, cbc, or gurobi.\n"
             << std::setw(41) << " "
@@ -107,6 +111,7 @@ void ConfigReader::read(Config* cfg, int argc, char** argv) const {
       {"dbg-output-path", required_argument, 0, 14},
       {"output-optgraph", required_argument, 0, 15},
       {"write-stats", no_argument, 0, 16},
+      {"precision", required_argument, 0, 17},
       {0, 0, 0, 0}};
 
   int c;
@@ -169,6 +174,9 @@ void ConfigReader::read(Config* cfg, int argc, char** argv) const {
       case 16:
         cfg->writeStats = true;
         break;
+      case 17:
+        cfg->outputPrecision = atoi(optarg);
+        break;
       case 'D':
         cfg->fromDot = true;
         break;
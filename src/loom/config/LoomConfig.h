@@ -32,6 +32,8 @@ struct Config {
   int ilpTimeLimit = -1;
   int ilpNumThreads = 0;
 
+  int outputPrecision = -1;
+
   double crossPenMultiSameSeg = 4;
   double crossPenMultiDiffSeg = 1;
   double separationPenWeight = 3;
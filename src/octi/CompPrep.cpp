@@ -0,0 +1,81 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include "octi/CompPrep.h"
+#include "util/log/Log.h"
+
+using octi::basegraph::BaseGraphType;
+using octi::combgraph::CombGraph;
+using octi::combgraph::CombNode;
+using shared::linegraph::LineGraph;
+using util::geo::DBox;
+
+// _____________________________________________________________________________
+double octi::avgStatDist(const LineGraph& g) {
+  double avg = 0;
+  size_t i = 0;
+  for (const auto nd : g.getNds()) {
+    if (nd->getDeg() == 0) continue;
+    i++;
+    double loc = 0;
+    for (const auto edg : nd->getAdjList()) {
+      loc += util::geo::dist(*nd->pl().getGeom(),
+                             *edg->getOtherNd(nd)->pl().getGeom());
+    }
+    avg += loc / nd->getAdjList().size();
+  }
+  return i ? avg / i : 0;
+}
+
+// _____________________________________________________________________________
+const CombNode* octi::getCenterNd(const CombGraph* cg) {
+  const CombNode* ret = 0;
+  for (auto nd : cg->getNds()) {
+    if (!ret || LineGraph::getLDeg(nd->pl().getParent()) >
+                    LineGraph::getLDeg(ret->pl().getParent())) {
+      ret = nd;
+    }
+  }
+
+  return ret;
+}
+
+// _____________________________________________________________________________
+DBox octi::prepComp(LineGraph* tg, double gridSize, size_t maxDeg) {
+  // contract degree 2 nodes without any significance (no station, no
+  // exception, no change in lines
+  tg->contractStrayNds();
+
+  // heuristic: contract all edges shorter than half the grid size
+  tg->contractEdges(gridSize / 2);
+
+  auto box = tg->getBBox();
+
+  // split nodes that have a larger degree than the max degree of the grid
+  // graph to allow drawing
+  tg->splitNodes(maxDeg);
+
+  return util::geo::pad(box, gridSize + 1);
+}
+
+// _____________________________________________________________________________
+DBox octi::drawBox(const CombGraph& cg, const DBox& box, BaseGraphType type) {
+  if (type != BaseGraphType::ORTHORADIAL &&
+      type != BaseGraphType::PSEUDOORTHORADIAL) {
+    return box;
+  }
+
+  auto centerNd = getCenterNd(&cg);
+
+  LOGTO(DEBUG, std::cerr) << "Orthoradial center node is "
+                          << centerNd->pl().getParent()->pl().toString();
+
+  auto cgCtr = *centerNd->pl().getGeom();
+  auto newBox = DBox();
+
+  newBox = util::geo::extendBox(box, newBox);
+  newBox = util::geo::extendBox(
+      util::geo::rotate(util::geo::convexHull(box), 180, cgCtr), newBox);
+  return newBox;
+}
@@ -0,0 +1,38 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef OCTI_COMPPREP_H_
+#define OCTI_COMPPREP_H_
+
+#include "octi/basegraph/BaseGraph.h"
+#include "octi/combgraph/CombGraph.h"
+#include "shared/linegraph/LineGraph.h"
+#include "util/geo/Geo.h"
+
+// Preparation of a connected input component for drawing, shared by the octi
+// and octi_bench binaries.
+
+namespace octi {
+
+// average distance of a node to its neighbors, over all non-isolated nodes
+double avgStatDist(const shared::linegraph::LineGraph& g);
+
+// the comb node whose parent node has the highest line degree
+const combgraph::CombNode* getCenterNd(const combgraph::CombGraph* cg);
+
+// contract stray nodes and edges shorter than half the grid size and split
+// nodes with a degree larger than maxDeg. Returns the bounding box of the
+// contracted graph, padded by the grid size.
+util::geo::DBox prepComp(shared::linegraph::LineGraph* tg, double gridSize,
+                         size_t maxDeg);
+
+// the box the comb graph should be drawn in for the given base graph type,
+// ortho-radial grids need box to be rotated around the center node
+util::geo::DBox drawBox(const combgraph::CombGraph& cg,
+                        const util::geo::DBox& box,
+                        basegraph::BaseGraphType type);
+
+}  // namespace octi
+
+#endif  // OCTI_COMPPREP_H_
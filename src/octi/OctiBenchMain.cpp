@@ -0,0 +1,364 @@
+// Copyright 2023
+// University of Freiburg - Chair of Algorithms and Datastructures
+// Author: Patrick Brosi <brosi@cs.uni-freiburg.de>
+
+#include <dirent.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "octi/CompPrep.h"
+#include "octi/Octilinearizer.h"
+#include "octi/_config.h"
+#include "octi/basegraph/BaseGraph.h"
+#include "octi/combgraph/CombGraph.h"
+#include "octi/config/OctiConfig.h"
+#include "shared/linegraph/LineGraph.h"
+#include "util/Misc.h"
+#include "util/geo/Geo.h"
+#include "util/json/Writer.h"
+#include "util/log/Log.h"
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_num_procs() 1
+#endif
+
+// Runs the octi heuristic on a set of datasets for every combination of base
+// graph type and grid size and writes the timings, router query counts,
+// peak memory and scores as a JSON array to stdout. Each run is done in its
+// own process, so the peak memory is measured per run.
+
+using octi::Octilinearizer;
+using octi::basegraph::BaseGraph;
+using octi::basegraph::BaseGraphType;
+using octi::combgraph::CombGraph;
+using octi::combgraph::Drawing;
+using octi::combgraph::Score;
+using shared::linegraph::LineGraph;
+
+struct BenchResult {
+  octi::DrawStats stats;
+  Score score;
+  double totalMs = 0;
+  size_t gridNds = 0;
+  size_t numComps = 0;
+  size_t numNoEmbeddingFound = 0;
+};
+
+// _____________________________________________________________________________
+void printHelp(const char* bin) {
+  std::cout << "Usage: " << bin << " [options] [<input files or dirs>]\n"
+            << "\nWithout inputs, the bundled example networks and the loom "
+               "test datasets are used.\n\n"
+            << "Options:\n"
+            << "  -b [ --base-graphs ] arg     comma separated base graph "
+               "types (=octilinear,\n"
+            << "                               "
+               "hexalinear,ortholinear,octihanan,quadtree)\n"
+            << "  -g [ --grid-sizes ] arg      comma separated grid sizes, "
+               "absolute or\n"
+            << "                               in %% of the avg. node "
+               "distance (=100%)\n"
+            << "  --heur-num-threads arg (=0)  number of parallel workers, 0 "
+               "means number\n"
+            << "                               of available cores, at most 4\n"
+            << "  --loc-search-max-iters arg   max local search iterations "
+               "(=100)\n"
+            << "  -h [ --help ]                show this help message\n";
+}
+
+// _____________________________________________________________________________
+std::vector<std::string> split(const std::string& s) {
+  std::vector<std::string> ret;
+  std::string cur;
+  for (char c : s + ",") {
+    if (c == ',') {
+      if (util::trim(cur).size()) ret.push_back(util::trim(cur));
+      cur.clear();
+    } else {
+      cur += c;
+    }
+  }
+  return ret;
+}
+
+// _____________________________________________________________________________
+bool baseGraphType(const std::string& s, BaseGraphType* t) {
+  if (s == "ortholinear") *t = BaseGraphType::GRID;
+  else if (s == "octilinear") *t = BaseGraphType::OCTIGRID;
+  else if (s == "hexalinear") *t = BaseGraphType::HEXGRID;
+  else if (s == "chulloctilinear") *t = BaseGraphType::CONVEXHULLOCTIGRID;
+  else if (s == "sparseoctilinear") *t = BaseGraphType::SPARSEOCTIGRID;
+  else if (s == "porthoradial") *t = BaseGraphType::PSEUDOORTHORADIAL;
+  else if (s == "quadtree") *t = BaseGraphType::OCTIQUADTREE;
+  else if (s == "octihanan") *t = BaseGraphType::OCTIHANANGRID;
+  else return false;
+  return true;
+}
+
+// _____________________________________________________________________________
+void addInputs(const std::string& path, std::vector<std::string>* ret) {
+  DIR* dir = opendir(path.c_str());
+  if (!dir) {
+    ret->push_back(path);
+    return;
+  }
+
+  std::vector<std::string> files;
+  struct dirent* ent;
+  while ((ent = readdir(dir))) {
+    std::string name = ent->d_name;
+    if (name.size() < 5 || name.substr(name.size() - 5) != ".json") continue;
+    files.push_back(path + "/" + name);
+  }
+  closedir(dir);
+
+  // deterministic order
+  std::sort(files.begin(), files.end());
+  ret->insert(ret->end(), files.begin(), files.end());
+}
+
+// _____________________________________________________________________________
+BenchResult bench(const std::string& path, const octi::config::Config& cfg) {
+  BenchResult ret;
+
+  std::ifstream in(path);
+  LineGraph lg;
+  lg.readFromJson(&in);
+  lg.topologizeIsects();
+
+  std::vector<LineGraph> comps = lg.distConnectedComponents(10000, false);
+  ret.numComps = comps.size();
+
+  for (auto& tg : comps) {
+    Octilinearizer oct(cfg.baseGraphType, cfg.heurNumThreads);
+
+    double gridSize = atof(cfg.gridSize.c_str());
+    if (util::trim(cfg.gridSize).back() == '%') {
+      gridSize = octi::avgStatDist(tg) * gridSize / 100;
+    }
+
+    if (gridSize <= 0) continue;
+
+    auto box = octi::prepComp(&tg, gridSize, oct.maxNodeDeg());
+
+    CombGraph cg(&tg, cfg.deg2Heur);
+    box = octi::drawBox(cg, box, cfg.baseGraphType);
+
+    LineGraph out;
+    BaseGraph* gg = 0;
+    Drawing d;
+
+    T_START(draw);
+    try {
+      Score sc = oct.draw(cg, box, &out, &gg, &d, cfg.pens, gridSize,
+                          cfg.borderRad, cfg.maxGrDist, cfg.orderMethod,
+                          cfg.restrLocSearch, cfg.enfGeoPen, cfg.hananIters,
+                          cfg.obstacles, cfg.heurLocSearchIters,
+                          cfg.abortAfter);
+      ret.score = ret.score + sc;
+    } catch (const octi::NoEmbeddingFoundExc&) {
+      ret.numNoEmbeddingFound++;
+    }
+    ret.totalMs += T_STOP(draw);
+
+    const auto& st = oct.getStats();
+    ret.stats.gridMs += st.gridMs;
+    ret.stats.geoPensMs += st.geoPensMs;
+    ret.stats.initialMs += st.initialMs;
+    ret.stats.locSearchMs += st.locSearchMs;
+    ret.stats.routerQueries += st.routerQueries;
+    ret.stats.locSearchIters += st.locSearchIters;
+
+    if (gg) {
+      ret.gridNds += gg->getNds().size();
+      delete gg;
+    }
+  }
+
+  return ret;
+}
+
+// _____________________________________________________________________________
+util::json::Dict benchJson(const std::string& input, const std::string& bg,
+                           const octi::config::Config& cfg) {
+  auto r = bench(input, cfg);
+
+  return util::json::Dict{
+      {"dataset", input},
+      {"base-graph", bg},
+      {"grid-size", cfg.gridSize},
+      {"num-comps", r.numComps},
+      {"num-comps-no-embedding-found", r.numNoEmbeddingFound},
+      {"gridgraph-nodes", r.gridNds},
+      {"time-ms", util::json::Dict{{"total", r.totalMs},
+                                   {"grid-construction", r.stats.gridMs},
+                                   {"geo-pens", r.stats.geoPensMs},
+                                   {"initial-routing", r.stats.initialMs},
+                                   {"local-search", r.stats.locSearchMs}}},
+      {"router-queries", r.stats.routerQueries},
+      {"local-search-iterations", r.stats.locSearchIters},
+      {"scores",
+       util::json::Dict{{"total-score", r.score.full},
+                        {"topo-violations",
+                         util::json::Int(r.score.violations)},
+                        {"density-score", r.score.dense},
+                        {"bend-score", r.score.bend},
+                        {"hop-score", r.score.hop},
+                        {"move-score", r.score.move}}},
+      {"procs", omp_get_num_procs()},
+      {"peak-memory", util::readableSize(util::getPeakRSS())},
+      {"peak-memory-bytes", util::getPeakRSS()}};
+}
+
+// _____________________________________________________________________________
+std::string benchIsolated(const std::string& input, const std::string& bg,
+                          const octi::config::Config& cfg) {
+  // the parent never runs any OpenMP regions, so forking is safe here
+  int fds[2];
+  if (pipe(fds) != 0) {
+    LOG(ERROR) << "Could not create pipe";
+    exit(1);
+  }
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    LOG(ERROR) << "Could not fork";
+    exit(1);
+  }
+
+  if (pid == 0) {
+    close(fds[0]);
+    std::stringstream ss;
+    util::json::Writer wr(&ss, 10, false);
+    wr.val(benchJson(input, bg, cfg));
+    wr.closeAll();
+    std::string res = ss.str();
+    size_t written = 0;
+    while (written < res.size()) {
+      ssize_t w = write(fds[1], res.data() + written, res.size() - written);
+      if (w <= 0) break;
+      written += w;
+    }
+    close(fds[1]);
+    _exit(0);
+  }
+
+  close(fds[1]);
+  std::string res;
+  char buf[4096];
+  ssize_t n;
+  while ((n = read(fds[0], buf, sizeof(buf))) > 0) res.append(buf, n);
+  close(fds[0]);
+
+  int status;
+  waitpid(pid, &status, 0);
+
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || res.empty()) {
+    std::stringstream ss;
+    util::json::Writer wr(&ss, 10, false);
+    wr.val(util::json::Dict{{"dataset", input},
+                            {"base-graph", bg},
+                            {"grid-size", cfg.gridSize},
+                            {"error", "run did not finish"}});
+    wr.closeAll();
+    return ss.str();
+  }
+
+  return res;
+}
+
+// _____________________________________________________________________________
+int main(int argc, char** argv) {
+  setbuf(stdout, NULL);
+
+  octi::config::Config cfg;
+  cfg.orderMethod = octi::config::OrderMethod::ALL;
+
+  std::vector<std::string> baseGraphs = {"octilinear", "hexalinear",
+                                         "ortholinear", "octihanan",
+                                         "quadtree"};
+  std::vector<std::string> gridSizes = {"100%"};
+
+  struct option ops[] = {{"base-graphs", required_argument, 0, 'b'},
+                         {"grid-sizes", required_argument, 0, 'g'},
+                         {"heur-num-threads", required_argument, 0, 1},
+                         {"loc-search-max-iters", required_argument, 0, 2},
+                         {"help", no_argument, 0, 'h'},
+                         {0, 0, 0, 0}};
+
+  int c;
+  while ((c = getopt_long(argc, argv, ":b:g:h", ops, 0)) != -1) {
+    switch (c) {
+      case 'b':
+        baseGraphs = split(optarg);
+        break;
+      case 'g':
+        gridSizes = split(optarg);
+        break;
+      case 1:
+        cfg.heurNumThreads = atoi(optarg);
+        break;
+      case 2:
+        cfg.heurLocSearchIters = atoi(optarg);
+        break;
+      case 'h':
+        printHelp(argv[0]);
+        exit(0);
+      case ':':
+        std::cerr << argv[optind - 1] << " requires an argument" << std::endl;
+        exit(1);
+      case '?':
+        std::cerr << argv[optind - 1] << " option unknown" << std::endl;
+        exit(1);
+    }
+  }
+
+  std::vector<std::string> inputs;
+  for (int i = optind; i < argc; i++) addInputs(argv[i], &inputs);
+
+  if (optind == argc) {
+    addInputs(SRC_DIR "/examples", &inputs);
+    addInputs(SRC_DIR "/src/loom/tests/datasets", &inputs);
+  }
+
+  for (const auto& bg : baseGraphs) {
+    BaseGraphType type;
+    if (!baseGraphType(bg, &type)) {
+      LOG(ERROR) << "Unknown base graph type " << bg;
+      exit(1);
+    }
+  }
+
+  std::cout << "[";
+  bool first = true;
+
+  for (const auto& input : inputs) {
+    for (const auto& bg : baseGraphs) {
+      baseGraphType(bg, &cfg.baseGraphType);
+
+      for (const auto& gs : gridSizes) {
+        LOGTO(INFO, std::cerr) << "Benchmarking " << input << " on " << bg
+                               << " with grid size " << gs;
+        cfg.gridSize = gs;
+
+        if (!first) std::cout << ",";
+        first = false;
+        std::cout << "\n" << benchIsolated(input, bg, cfg);
+      }
+    }
+  }
+
+  std::cout << "\n]" << std::endl;
+
+  return 0;
+}
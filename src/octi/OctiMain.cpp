@@ -5,17 +5,25 @@
 #include <stdio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "3rdparty/json.hpp"
+#include "octi/CompPrep.h"
 #include "octi/Enlarger.h"
 #include "octi/Octilinearizer.h"
 #include "octi/basegraph/BaseGraph.h"
 #include "octi/combgraph/CombGraph.h"
 #include "octi/config/ConfigReader.h"
 #include "shared/linegraph/LineGraph.h"
+#include "shared/output/GeoGraphJsonWriter.h"
 #include "util/Misc.h"
 #include "util/geo/Geo.h"
 #include "util/geo/output/GeoGraphJsonOutput.h"
@@ -26,6 +34,7 @@
 #include <omp.h>
 #else
 #define omp_get_num_procs() 1
+#define omp_in_parallel() 0
 #endif
 
 using std::string;
@@ -53,34 +62,36 @@ struct TotalScore {
 };
 
 // _____________________________________________________________________________
-double avgStatDist(const LineGraph& g) {
-  double avg = 0;
-  size_t i = 0;
-  for (const auto nd : g.getNds()) {
-    if (nd->getDeg() == 0) continue;
-    i++;
-    double loc = 0;
-    for (const auto edg : nd->getAdjList()) {
-      loc += dist(*nd->pl().getGeom(), *edg->getOtherNd(nd)->pl().getGeom());
-    }
-    avg += loc / nd->getAdjList().size();
-  }
-  avg /= i++;
-  return avg;
+inline TotalScore operator+(const TotalScore& lh, const TotalScore& rh) {
+  TotalScore ret;
+  ret.score = lh.score + rh.score;
+  ret.ilpstats = lh.ilpstats + rh.ilpstats;
+  ret.gridgraphNumNds = lh.gridgraphNumNds + rh.gridgraphNumNds;
+  ret.gridgraphNumEdgs = lh.gridgraphNumEdgs + rh.gridgraphNumEdgs;
+  ret.combgraphNumNds = lh.combgraphNumNds + rh.combgraphNumNds;
+  ret.combgraphNumEdgs = lh.combgraphNumEdgs + rh.combgraphNumEdgs;
+  ret.inputgraphNumNds = lh.inputgraphNumNds + rh.inputgraphNumNds;
+  ret.inputgraphNumEdgs = lh.inputgraphNumEdgs + rh.inputgraphNumEdgs;
+  ret.inputgraphMaxDeg = std::max(lh.inputgraphMaxDeg, rh.inputgraphMaxDeg);
+  ret.numNoEmbeddingFound = lh.numNoEmbeddingFound + rh.numNoEmbeddingFound;
+  ret.timeMs = lh.timeMs + rh.timeMs;
+  return ret;
 }
 
-// _____________________________________________________________________________
-const CombNode* getCenterNd(const CombGraph* cg) {
-  const CombNode* ret = 0;
-  for (auto nd : cg->getNds()) {
-    if (!ret || LineGraph::getLDeg(nd->pl().getParent()) >
-                    LineGraph::getLDeg(ret->pl().getParent())) {
-      ret = nd;
-    }
-  }
+// Results of a single component, merged into the global results in
+// component order.
+struct CompResult {
+  util::json::Array jsonScores;
+  std::vector<LineGraph*> resultGraphs;
+  std::vector<BaseGraph*> resultGridGraphs;
+  TotalScore totScore;
 
-  return ret;
-}
+  // set if no embedding was found and we are not allowed to skip
+  std::string error;
+
+  // input graphs copied for speculative retries, kept alive until output
+  std::vector<LineGraph> inputGraphs;
+};
 
 // _____________________________________________________________________________
 std::vector<DPolygon> readObstacleFile(const std::string& p) {
@@ -107,15 +118,26 @@ std::vector<DPolygon> readObstacleFile(const std::string& p) {
   return ret;
 }
 
+// _____________________________________________________________________________
+size_t heurJobs(const config::Config& cfg) {
+  // inside a component or retry worker, the heuristic's own parallel regions
+  // are nested and thus inactive. Additional workers would then only hold
+  // more grid graphs and be processed one after another.
+  if (omp_in_parallel()) return 1;
+  return cfg.heurNumThreads;
+}
+
 // _____________________________________________________________________________
 void drawComp(LineGraph& tg, double avgDist, util::json::Array& jsonScores,
               std::vector<LineGraph*>& resultGraphs,
               std::vector<BaseGraph*>& resultGridGraphs, TotalScore& totScore,
-              const config::Config& cfg) {
+              const config::Config& cfg, const std::atomic<bool>* cancel) {
   Drawing d;
 
-  Octilinearizer oct(cfg.baseGraphType);
-  LineGraph* res = new LineGraph();
+  Octilinearizer oct(cfg.baseGraphType, heurJobs(cfg));
+  oct.setCancelFlag(cancel);
+  // owned here until the drawing succeeded, draw() may throw
+  std::unique_ptr<LineGraph> res(new LineGraph());
   BaseGraph* gg;
 
   double gridSize;
@@ -130,36 +152,10 @@ void drawComp(LineGraph& tg, double avgDist, util::json::Array& jsonScores,
     LOGTO(DEBUG, std::cerr) << "Grid size " << gridSize;
   }
 
-  // contract degree 2 nodes without any significance (no station, no
-  // exception, no change in lines
-  tg.contractStrayNds();
-
-  // heuristic: contract all edges shorter than half the grid size
-  tg.contractEdges(gridSize / 2);
-
-  auto box = tg.getBBox();
-
-  // split nodes that have a larger degree than the max degree of the grid
-  // graph to allow drawing
-  tg.splitNodes(oct.maxNodeDeg());
+  auto box = prepComp(&tg, gridSize, oct.maxNodeDeg());
 
   CombGraph cg(&tg, cfg.deg2Heur);
-  box = util::geo::pad(box, gridSize + 1);
-
-  if (cfg.baseGraphType == octi::basegraph::BaseGraphType::ORTHORADIAL ||
-      cfg.baseGraphType == octi::basegraph::BaseGraphType::PSEUDOORTHORADIAL) {
-    auto centerNd = getCenterNd(&cg);
-
-    LOGTO(DEBUG, std::cerr) << "Orthoradial center node is "
-                            << centerNd->pl().getParent()->pl().toString();
-
-    auto cgCtr = *centerNd->pl().getGeom();
-    auto newBox = util::geo::DBox();
-
-    newBox = extendBox(box, newBox);
-    newBox = extendBox(rotate(convexHull(box), 180, cgCtr), newBox);
-    box = newBox;
-  }
+  box = drawBox(cg, box, cfg.baseGraphType);
 
   Score sc;
   octi::ilp::ILPStats ilpstats;
@@ -167,18 +163,21 @@ void drawComp(LineGraph& tg, double avgDist, util::json::Array& jsonScores,
 
   if (cfg.optMode == "ilp") {
     T_START(octi);
-    sc = oct.drawILP(cg, box, res, &gg, &d, cfg.pens, gridSize, cfg.borderRad,
-                     cfg.maxGrDist, cfg.orderMethod, cfg.ilpNoSolve,
-                     cfg.enfGeoPen, cfg.hananIters, cfg.ilpTimeLimit,
-                     cfg.ilpCacheDir, cfg.ilpCacheThreshold, cfg.ilpNumThreads,
+    sc = oct.drawILP(cg, box, res.get(), &gg, &d, cfg.pens, gridSize,
+                     cfg.borderRad, cfg.maxGrDist, cfg.orderMethod,
+                     cfg.ilpNoSolve,
+                     cfg.enfGeoPen, cfg.hananIters, cfg.ilpCorridor,
+                     cfg.ilpCorridorIters, cfg.ilpPruneSlack,
+                     cfg.ilpTimeLimit, cfg.ilpCacheDir, cfg.ilpCacheThreshold, cfg.ilpNumThreads,
                      &ilpstats, cfg.ilpSolver, cfg.ilpPath);
     time = T_STOP(octi);
     LOGTO(DEBUG, std::cerr)
         << "Schematized using ILP in " << time << " ms, score " << sc.full;
   } else if ((cfg.optMode == "heur")) {
     T_START(octi);
-    sc = oct.draw(cg, box, res, &gg, &d, cfg.pens, gridSize, cfg.borderRad,
-                  cfg.maxGrDist, cfg.orderMethod, cfg.restrLocSearch,
+    sc = oct.draw(cg, box, res.get(), &gg, &d, cfg.pens, gridSize,
+                  cfg.borderRad, cfg.maxGrDist, cfg.orderMethod,
+                  cfg.restrLocSearch,
                   cfg.enfGeoPen, cfg.hananIters, cfg.obstacles,
                   cfg.heurLocSearchIters, cfg.abortAfter);
     time = T_STOP(octi);
@@ -263,6 +262,8 @@ void drawComp(LineGraph& tg, double avgDist, util::json::Array& jsonScores,
       jsonScore["ilp"] = util::json::Dict{
           {"size",
            util::json::Dict{{"rows", ilpstats.rows}, {"cols", ilpstats.cols}}},
+          {"pruned", util::json::Dict{{"rows", ilpstats.prunedRows},
+                                      {"cols", ilpstats.prunedCols}}},
           {"solve-time", ilpstats.time},
           {"optimal", util::json::Bool{ilpstats.optimal}}};
     }
@@ -270,12 +271,135 @@ void drawComp(LineGraph& tg, double avgDist, util::json::Array& jsonScores,
     jsonScores.push_back(jsonScore);
   }
 
-  resultGraphs.push_back(res);
+  resultGraphs.push_back(res.release());
 
   if (cfg.printMode == "gridgraph") {
     resultGridGraphs.push_back(gg);
   } else {
-    delete gg;
+    oct.releaseBaseGraph(gg, cfg.borderRad);
+  }
+}
+
+// _____________________________________________________________________________
+void freeCompResult(CompResult* res) {
+  for (auto g : res->resultGraphs) delete g;
+  for (auto gg : res->resultGridGraphs) delete gg;
+  res->resultGraphs.clear();
+  res->resultGridGraphs.clear();
+}
+
+// _____________________________________________________________________________
+void drawCompSpeculative(LineGraph& tg, double avgDist, size_t maxTries,
+                         CompResult* res, const config::Config& cfg) {
+  // try the grid sizes of the next retryNumParallel retries at once, each on
+  // its own copy of the input. The largest grid size which could be drawn
+  // wins, attempts with smaller grid sizes are cancelled as soon as a larger
+  // one succeeded. Each attempt uses a single heuristic worker, see
+  // heurJobs(), so a batch holds retryNumParallel grid graphs at most.
+  size_t batchSize = cfg.retryNumParallel;
+
+  for (size_t first = 0; first < maxTries; first += batchSize) {
+    size_t n = std::min(batchSize, maxTries - first);
+
+    std::vector<LineGraph> graphs(n);
+    std::vector<CompResult> attempts(n);
+    std::vector<char> drawn(n, 0);
+    std::unique_ptr<std::atomic<bool>[]> cancel(new std::atomic<bool>[n]);
+
+    for (size_t i = 0; i < n; i++) {
+      tg.copyTo(&graphs[i]);
+      cancel[i] = false;
+    }
+
+#pragma omp parallel for num_threads(n) schedule(static, 1)
+    for (size_t i = 0; i < n; i++) {
+      double curDist = avgDist * pow(0.85, first + i);
+      LOGTO(DEBUG, std::cerr) << "Trying grid size " << curDist;
+      try {
+        drawComp(graphs[i], curDist, attempts[i].jsonScores,
+                 attempts[i].resultGraphs, attempts[i].resultGridGraphs,
+                 attempts[i].totScore, cfg, &cancel[i]);
+        drawn[i] = 1;
+        for (size_t j = i + 1; j < n; j++) cancel[j] = true;
+      } catch (const NoEmbeddingFoundExc&) {
+      } catch (const DrawingCancelledExc&) {
+      }
+    }
+
+    bool found = false;
+    for (size_t i = 0; i < n; i++) {
+      if (drawn[i] && !found) {
+        found = true;
+        *res = std::move(attempts[i]);
+        res->inputGraphs.push_back(std::move(graphs[i]));
+      } else {
+        freeCompResult(&attempts[i]);
+      }
+    }
+
+    if (found) return;
+
+    if (first + n < maxTries) {
+      LOGTO(WARN, std::cerr)
+          << "Retrying with grid size " << avgDist * pow(0.85, first + n);
+    }
+  }
+
+  NoEmbeddingFoundExc exc;
+
+  if (cfg.skipOnError) {
+    res->totScore.numNoEmbeddingFound += 1;
+    res->jsonScores.push_back(util::json::Dict());
+    LOGTO(WARN, std::cerr) << exc.what();
+    return;
+  }
+
+  res->error = exc.what();
+}
+
+// _____________________________________________________________________________
+void drawCompRetry(LineGraph& tg, size_t i, CompResult* res,
+                   const config::Config& cfg) {
+  LOGTO(DEBUG, std::cerr) << "@ component " << i;
+  double avgDist = avgStatDist(tg);
+
+  double curDist = avgDist;
+
+  size_t tries = 0;
+  size_t MAX_TRIES = 10;
+
+  LOGTO(DEBUG, std::cerr) << "Average adj. node distance is " << avgDist;
+
+  // the ILP solvers are not guaranteed to be thread safe
+  if (cfg.retryOnError && cfg.retryNumParallel > 1 && cfg.optMode != "ilp") {
+    drawCompSpeculative(tg, avgDist, MAX_TRIES, res, cfg);
+    return;
+  }
+
+  while (tries < MAX_TRIES) {
+    try {
+      drawComp(tg, curDist, res->jsonScores, res->resultGraphs,
+               res->resultGridGraphs, res->totScore, cfg, 0);
+
+      break;
+    } catch (const NoEmbeddingFoundExc& exc) {
+      if (cfg.retryOnError && tries < MAX_TRIES) {
+        curDist *= 0.85;
+        tries++;
+        LOGTO(WARN, std::cerr) << "Retrying with grid size " << curDist;
+        continue;
+      }
+
+      if (cfg.skipOnError) {
+        res->totScore.numNoEmbeddingFound += 1;
+        res->jsonScores.push_back(util::json::Dict());
+        LOGTO(WARN, std::cerr) << exc.what();
+        break;
+      }
+
+      res->error = exc.what();
+      break;
+    }
   }
 }
 
@@ -327,47 +451,39 @@ int main(int argc, char** argv) {
 
   TotalScore totScore;
 
-  size_t i = 0;
-
-  for (auto& tg : comps) {
-    LOGTO(DEBUG, std::cerr) << "@ component " << i++;
-    double avgDist = avgStatDist(tg);
-
-    double curDist = avgDist;
-
-    size_t tries = 0;
-    size_t MAX_TRIES = 10;
+  // components share no state, draw them in parallel. The ILP solvers are
+  // not guaranteed to be thread safe, so ILP mode is always serial.
+  size_t compJobs = cfg.compNumThreads;
+  if (compJobs == 0) compJobs = omp_get_num_procs();
+  if (cfg.optMode == "ilp") compJobs = 1;
+  compJobs = std::max<size_t>(1, std::min(compJobs, comps.size()));
 
-    LOGTO(DEBUG, std::cerr) << "Average adj. node distance is " << avgDist;
+  std::vector<CompResult> compResults(comps.size());
 
-    while (tries < MAX_TRIES) {
-      try {
-        drawComp(tg, curDist, jsonScores, resultGraphs, resultGridGraphs,
-                 totScore, cfg);
+#pragma omp parallel for num_threads(compJobs) schedule(dynamic)
+  for (size_t i = 0; i < comps.size(); i++) {
+    drawCompRetry(comps[i], i, &compResults[i], cfg);
+  }
 
-        break;
-      } catch (const NoEmbeddingFoundExc& exc) {
-        if (cfg.retryOnError && tries < MAX_TRIES) {
-          curDist *= 0.85;
-          tries++;
-          LOGTO(WARN, std::cerr) << "Retrying with grid size " << curDist;
-          continue;
-        }
+  // no further drawings, don't keep the reusable grid graphs until exit
+  Octilinearizer::clearBaseGraphPool();
 
-        if (cfg.skipOnError) {
-          totScore.numNoEmbeddingFound += 1;
-          jsonScores.push_back(util::json::Dict());
-          LOGTO(WARN, std::cerr) << exc.what();
-          break;
-        }
-
-        LOG(ERROR) << exc.what();
-        exit(1);
-      }
+  // merge in component order, the output does not depend on compJobs
+  for (auto& res : compResults) {
+    if (res.error.size()) {
+      LOG(ERROR) << res.error;
+      exit(1);
     }
-  }
 
-  util::geo::output::GeoGraphJsonOutput gout;
+    jsonScores.insert(jsonScores.end(), res.jsonScores.begin(),
+                      res.jsonScores.end());
+    resultGraphs.insert(resultGraphs.end(), res.resultGraphs.begin(),
+                        res.resultGraphs.end());
+    resultGridGraphs.insert(resultGridGraphs.end(),
+                            res.resultGridGraphs.begin(),
+                            res.resultGridGraphs.end());
+    totScore = totScore + res.totScore;
+  }
 
   size_t maxRss = util::getPeakRSS();
 
@@ -418,40 +534,44 @@ int main(int argc, char** argv) {
     totalScore["ilp"] = util::json::Dict{
         {"size", util::json::Dict{{"rows", totScore.ilpstats.rows},
                                   {"cols", totScore.ilpstats.cols}}},
+        {"pruned", util::json::Dict{{"rows", totScore.ilpstats.prunedRows},
+                                    {"cols", totScore.ilpstats.prunedCols}}},
         {"solve-time", totScore.ilpstats.time},
         {"optimal", util::json::Bool{totScore.ilpstats.optimal}}};
   }
 
   if (cfg.printMode == "gridgraph") {
     if (cfg.writeStats) {
-      util::geo::output::GeoJsonOutput out(
-          std::cout, util::json::Dict{{"statistics", totalScore},
-                                      {"component-statistics", jsonScores}});
+      shared::output::GeoGraphJsonWriter out(
+          &std::cout, cfg.outputPrecision,
+          util::json::Dict{{"statistics", totalScore},
+                           {"component-statistics", jsonScores}});
       for (auto gg : resultGridGraphs) {
-        gout.printLatLng(*gg, &out);
+        out.printLatLng(*gg);
       }
       out.flush();
     } else {
-      util::geo::output::GeoJsonOutput out(std::cout);
+      shared::output::GeoGraphJsonWriter out(&std::cout, cfg.outputPrecision);
       for (auto gg : resultGraphs) {
-        gout.printLatLng(*gg, &out);
+        out.printLatLng(*gg);
       }
       out.flush();
     }
   } else {
     if (cfg.writeStats) {
-      util::geo::output::GeoJsonOutput out(
-          std::cout, util::json::Dict{{"statistics", totalScore},
-                                      {"component-statistics", jsonScores}});
+      shared::output::GeoGraphJsonWriter out(
+          &std::cout, cfg.outputPrecision,
+          util::json::Dict{{"statistics", totalScore},
+                           {"component-statistics", jsonScores}});
       for (auto res : resultGraphs) {
-        gout.printLatLng(*res, &out);
+        out.printLatLng(*res);
       }
       out.flush();
     } else {
-      util::geo::output::GeoJsonOutput out(std::cout);
+      shared::output::GeoGraphJsonWriter out(&std::cout, cfg.outputPrecision);
 
       for (auto res : resultGraphs) {
-        gout.printLatLng(*res, &out);
+        out.printLatLng(*res);
       }
       out.flush();
     }
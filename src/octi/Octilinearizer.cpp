@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <mutex>
 #include <thread>
 #include "ilp/ILPGridOptimizer.h"
 #include "octi/Octilinearizer.h"
@@ -17,12 +18,18 @@
 #include "octi/basegraph/OctiQuadTree.h"
 #include "octi/basegraph/OrthoRadialGraph.h"
 #include "octi/basegraph/PseudoOrthoRadialGraph.h"
+#include "octi/basegraph/SparseOctiGridGraph.h"
 #include "octi/combgraph/Drawing.h"
 #include "util/Misc.h"
 #include "util/geo/output/GeoGraphJsonOutput.h"
 #include "util/graph/BiDijkstra.h"
 #include "util/graph/Dijkstra.h"
 #include "util/log/Log.h"
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_num_procs() 1
+#endif
 
 using namespace octi;
 using namespace basegraph;
@@ -43,14 +50,126 @@ using util::geo::Polygon;
 using util::graph::BiDijkstra;
 using util::graph::Dijkstra;
 
+namespace {
+
+// every heuristic worker holds a full grid graph, so by default not more
+// than this many workers are used, no matter how many cores are available
+const size_t DEFAULT_MAX_JOBS = 4;
+
+// _____________________________________________________________________________
+// extend box by the grid nodes used by the paths of the edges adjacent to a
+void extendCorridor(const Drawing& d, const CombNode* a, const BaseGraph* gg,
+                    DBox* box) {
+  const auto& paths = d.getEdgPaths();
+  for (auto ce : a->getAdjList()) {
+    auto it = paths.find(ce);
+    if (it == paths.end()) continue;
+    for (const auto& eid : it->second) {
+      auto fr = gg->getGrNdById(eid.first)->pl().getParent();
+      auto to = gg->getGrNdById(eid.second)->pl().getParent();
+      *box = util::geo::extendBox(*fr->pl().getGeom(), *box);
+      *box = util::geo::extendBox(*to->pl().getGeom(), *box);
+    }
+  }
+}
+
+// upper bound for the estimated memory held by pooled grid graphs
+const size_t MAX_POOL_BYTES = 256 * 1024 * 1024;
+
+// grid graphs of finished drawings, kept for reuse by later drawings on a
+// grid of the same type, cell size, spacer and dimensions
+struct PooledGraph {
+  BaseGraphType type;
+  double spacer;
+  BaseGraph* gg;
+  size_t bytes;
+};
+
+struct BaseGraphPool {
+  ~BaseGraphPool() { clear(); }
+
+  void clear() {
+    for (const auto& p : graphs) delete p.gg;
+    graphs.clear();
+    bytes = 0;
+  }
+
+  std::mutex mutex;
+  std::vector<PooledGraph> graphs;
+
+  // estimated memory held by the pooled graphs
+  size_t bytes = 0;
+};
+
+BaseGraphPool graphPool;
+
+// _____________________________________________________________________________
+// rough estimate of the memory held by the nodes and edges of gg
+size_t graphBytes(const BaseGraph* gg) {
+  size_t ret = 0;
+  for (auto n : gg->getNds()) {
+    ret += sizeof(util::graph::DirNode<GridNodePL, GridEdgePL>);
+
+    // each edge is listed in the out list of its source and the in list of
+    // its target
+    ret += n->getAdjListOut().size() * (sizeof(GridEdge) + 2 * sizeof(void*));
+  }
+  return ret;
+}
+
+// hands the worker grid graphs of a drawing back on every exit path, except
+// for the ones taken out
+class WorkerGraphs {
+ public:
+  WorkerGraphs(const Octilinearizer* oct, size_t jobs, double spacer)
+      : _oct(oct), _spacer(spacer), _ggs(jobs, 0) {}
+
+  ~WorkerGraphs() {
+    for (auto gg : _ggs) _oct->releaseBaseGraph(gg, _spacer);
+  }
+
+  BaseGraph*& operator[](size_t i) { return _ggs[i]; }
+  const std::vector<BaseGraph*>& get() const { return _ggs; }
+
+  BaseGraph* take(size_t i) {
+    auto ret = _ggs[i];
+    _ggs[i] = 0;
+    return ret;
+  }
+
+ private:
+  const Octilinearizer* _oct;
+  double _spacer;
+  std::vector<BaseGraph*> _ggs;
+};
+
+// _____________________________________________________________________________
+bool samePens(const Penalties& a, const Penalties& b) {
+  return a.p_0 == b.p_0 && a.p_45 == b.p_45 && a.p_90 == b.p_90 &&
+         a.p_135 == b.p_135 && a.verticalPen == b.verticalPen &&
+         a.horizontalPen == b.horizontalPen && a.diagonalPen == b.diagonalPen &&
+         a.densityPen == b.densityPen && a.ndMovePen == b.ndMovePen;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________
+Octilinearizer::Octilinearizer(BaseGraphType baseGraphType, size_t jobs)
+    : _baseGraphType(baseGraphType), _jobs(jobs), _cancel(0) {
+  if (_jobs == 0) {
+    _jobs = std::min<size_t>(DEFAULT_MAX_JOBS, omp_get_num_procs());
+  }
+}
+
 // _____________________________________________________________________________
 Score Octilinearizer::drawILP(
     const CombGraph& cg, const util::geo::DBox& box, LineGraph* outTg,
     BaseGraph** retGg, Drawing* dOut, const Penalties& pens, double gridSize,
     double borderRad, double maxGrDist, OrderMethod orderMethod, bool noSolve,
-    double enfGeoPen, size_t hananIters, int timeLim,
-    const std::string& cacheDir, double cacheThreshold, int numThreads,
-    octi::ilp::ILPStats* stats, const std::string& solverStr,
+    double enfGeoPen, size_t hananIters, double corridorRad,
+    size_t corridorIters, double pruneSlack, int timeLim,
+    const std::string& cacheDir,
+    double cacheThreshold, int numThreads, octi::ilp::ILPStats* stats, const std::string& solverStr,
     const std::string& path) {
   BaseGraph* gg;
   Drawing drawing;
@@ -73,7 +192,6 @@ Score Octilinearizer::drawILP(
   } catch (const NoEmbeddingFoundExc& exc) {
     LOGTO(DEBUG, std::cerr) << "Presolve was not successful.";
     gg = newBaseGraph(box, cg, gridSize, borderRad, hananIters, pensCpy);
-    gg->init();
     drawing = Drawing(gg);
   }
 
@@ -84,9 +202,7 @@ Score Octilinearizer::drawILP(
     auto edges = getOrdering(cg, OrderMethod::NUM_LINES);
     LOGTO(DEBUG, std::cerr) << "Writing geopens for " << edges.size() << " edges";
     T_START(geopens);
-    for (auto cmbEdg : edges) {
-      gg->writeGeoCoursePens(cmbEdg, &enfGeoPens, enfGeoPen);
-    }
+    writeGeoPens(gg, edges, enfGeoPen, &enfGeoPens);
     LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(geopens) << "ms)";
     geoPens = &enfGeoPens;
   }
@@ -102,9 +218,10 @@ Score Octilinearizer::drawILP(
 
   ilp::ILPGridOptimizer ilpoptim;
 
-  *stats =
-      ilpoptim.optimize(gg, cg, &drawing, maxGrDist, noSolve, geoPens, timeLim,
-                        cacheDir, cacheThreshold, numThreads, solverStr, path);
+  *stats = ilpoptim.optimize(gg, cg, &drawing, maxGrDist, noSolve, geoPens,
+                             corridorRad, corridorIters, pruneSlack, timeLim,
+                             cacheDir, cacheThreshold, numThreads, solverStr,
+                             path);
 
   drawing.getLineGraph(outTg);
   *retGg = gg;
@@ -125,18 +242,45 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
                            double enfGeoPen, size_t hananIters,
                            const std::vector<Polygon<double>>& obstacles,
                            size_t locSearchIters, size_t abortAfter) {
-  size_t jobs = 4;
-  std::vector<BaseGraph*> ggs(jobs);
+  if (cancelled()) throw DrawingCancelledExc();
+
+  _stats = DrawStats();
+
+  std::vector<OrderMethod> methods = {
+      OrderMethod::NUM_LINES,     OrderMethod::LENGTH,
+      OrderMethod::ADJ_ND_DEGREE, OrderMethod::ADJ_ND_LDEGREE,
+      OrderMethod::GROWTH_DEG,    OrderMethod::GROWTH_LDEG};
+
+  if (orderMethod != OrderMethod::ALL) {
+    methods = {orderMethod};
+  }
+
+  size_t numCmbNds = 0;
+  for (auto nd : cg.getNds()) {
+    if (nd->getDeg() != 0) numCmbNds++;
+  }
+
+  // every worker holds a full grid graph, so never use more workers than
+  // there are initial orderings or local search nodes to distribute
+  size_t jobs = std::min(_jobs, std::max(methods.size(), numCmbNds));
+  if (jobs == 0) jobs = 1;
+
+  // released when leaving draw(), also if no embedding was found
+  WorkerGraphs ggs(this, jobs, borderRad);
+
+  // per-worker routing state
+  std::vector<GridRouter> routers(jobs);
 
   LOGTO(DEBUG, std::cerr) << "Creating grid graphs... ";
   T_START(ggraph);
 #pragma omp parallel for
   for (size_t i = 0; i < jobs; i++) {
     ggs[i] = newBaseGraph(box, cg, gridSize, borderRad, hananIters, pens);
-    ggs[i]->init();
+    routers[i].setBaseGraph(ggs[i]);
   }
 
-  LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(ggraph) << "ms)";
+  _stats.gridMs = T_STOP(ggraph);
+  LOGTO(DEBUG, std::cerr) << "Done. (" << _stats.gridMs << "ms)";
 
   LOGTO(DEBUG, std::cerr) << "Grid graph has " << ggs[0]->getNds().size()
                           << " nodes";
@@ -153,20 +297,16 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
   if (enfGeoPen > 0) {
     LOGTO(DEBUG, std::cerr) << "Writing geopens for " << edges.size() << " edges";
     T_START(geopens);
-    size_t i = 0;
-    for (auto cmbEdg : edges) {
-      i++;
-      LOGTO(DEBUG, std::cerr) << "@ " << i << "/" << edges.size();
-      ggs[0]->writeGeoCoursePens(cmbEdg, &enfGeoPens, enfGeoPen);
-    }
-    LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(geopens) << "ms)";
+    writeGeoPens(ggs[0], edges, enfGeoPen, &enfGeoPens);
+    _stats.geoPensMs = T_STOP(geopens);
+    LOGTO(DEBUG, std::cerr) << "Done. (" << _stats.geoPensMs << "ms)";
     geoPens = &enfGeoPens;
   }
 
   if (obstacles.size()) {
     LOGTO(DEBUG, std::cerr) << "Writing obstacles... ";
     T_START(obstacles);
-    for (auto gg : ggs)
+    for (auto gg : ggs.get())
       for (const auto& obst : obstacles) gg->addObstacle(obst);
     LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(obstacles) << "ms)";
   }
@@ -176,25 +316,20 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
 
   // try our default edge ordering first, without any randomization
 
-  std::vector<OrderMethod> methods = {
-      OrderMethod::NUM_LINES,     OrderMethod::LENGTH,
-      OrderMethod::ADJ_ND_DEGREE, OrderMethod::ADJ_ND_LDEGREE,
-      OrderMethod::GROWTH_DEG,    OrderMethod::GROWTH_LDEG};
-
-  if (orderMethod != OrderMethod::ALL) {
-    methods = {orderMethod};
-  }
-
   std::vector<std::vector<OrderMethod>> batches(jobs);
   for (size_t i = 0; i < methods.size(); i++) {
     batches[i % jobs].push_back(methods[i]);
   }
 
   LOGTO(DEBUG, std::cerr) << "Searching initial drawing... ";
+  T_START(initial);
 
 #pragma omp parallel for
   for (size_t btch = 0; btch < jobs; btch++) {
     for (OrderMethod meth : batches[btch]) {
+      // we cannot throw inside the parallel region
+      if (cancelled()) break;
+
       T_START(draw);
       Drawing drawingCp(ggs[btch]);
 
@@ -206,8 +341,8 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
 #pragma omp critical
       { bestScoreSoFar = drawing.score(); }
 
-      auto status = draw(iterOrder, ggs[btch], &drawingCp, bestScoreSoFar,
-                         maxGrDist, geoPens, abortAfter);
+      auto status = draw(iterOrder, ggs[btch], &routers[btch], &drawingCp,
+                         bestScoreSoFar, maxGrDist, geoPens, abortAfter);
 
       drawingCp.eraseFromGrid(ggs[btch]);
 
@@ -225,40 +360,64 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
     }
   }
 
+  if (cancelled()) throw DrawingCancelledExc();
+
+  _stats.initialMs = T_STOP(initial);
+
   if (drawing.score() == INF) throw NoEmbeddingFoundExc();
 
   LOGTO(DEBUG, std::cerr) << "Done.";
 
   for (size_t i = 0; i < jobs; i++) drawing.applyToGrid(ggs[i]);
 
+  // moves are committed on the first grid graph
+  drawing.setBaseGraph(ggs[0]);
+
   size_t iters = 0;
 
   LOGTO(DEBUG, std::cerr) << "Initial score: " << drawing.score() << " ("
                           << drawing.violations() << " topology violations).";
   LOGTO(DEBUG, std::cerr) << "Starting local search...";
+  T_START(locsearch);
 
   // dont use local search if abortAfter is set
   if (abortAfter != std::numeric_limits<size_t>::max()) LOCAL_SEARCH_ITERS = 0;
 
-  std::vector<std::vector<CombNode*>> batchesLoc(jobs);
-  size_t c = 0;
+  std::vector<CombNode*> locNds;
+  std::vector<std::vector<size_t>> batchesLoc(jobs);
   for (auto nd : cg.getNds()) {
     if (nd->getDeg() == 0) continue;
-    batchesLoc[c % jobs].push_back(nd);
-    c++;
+    batchesLoc[locNds.size() % jobs].push_back(locNds.size());
+    locNds.push_back(nd);
   }
 
   for (; iters < LOCAL_SEARCH_ITERS; iters++) {
+    if (cancelled()) throw DrawingCancelledExc();
+
     T_START(iter);
-    std::vector<Drawing> bestFrIters(jobs);
+
+    double prevScore = drawing.score();
+
+    // the best move of each node, all evaluated against the current drawing
+    std::vector<LocSearchMove> moves(locNds.size());
 
 #pragma omp parallel for
     for (size_t btch = 0; btch < jobs; btch++) {
-      for (auto a : batchesLoc[btch]) {
-        Drawing drawingCp = drawing;
+      // a single working copy per batch, all changes made for a node are
+      // rolled back via the undo log of the drawing
+      Drawing drawingCp = drawing;
+
+      // use the batches grid graph
+      drawingCp.setBaseGraph(ggs[btch]);
+
+      for (size_t ndIdx : batchesLoc[btch]) {
+        auto a = locNds[ndIdx];
+        auto& move = moves[ndIdx];
 
-        // use the batches grid graph
-        drawingCp.setBaseGraph(ggs[btch]);
+        // only improving moves are of interest
+        move.score = prevScore;
+
+        drawingCp.checkpoint();
 
         // reverting a
         std::vector<CombEdge*> test;
@@ -288,56 +447,104 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
             if (gridD >= maxDis) continue;
           }
 
-          Drawing run = drawingCp;
+          drawingCp.checkpoint();
 
-          // we can use bestFromIter.score() as the limit for the shortest
-          // path computation, as we can already do at least as good.
-          auto error =
-              draw(test, p, ggs[btch], &run, bestFrIters[btch].score(),
-                   maxGrDist, geoPens, std::numeric_limits<size_t>::max());
+          // we can use the best score for this node as the limit for the
+          // shortest path computation, as we can already do at least as good
+          auto error = draw(test, p, ggs[btch], &routers[btch], &drawingCp,
+                            move.score, maxGrDist, geoPens,
+                            std::numeric_limits<size_t>::max());
 
-          if (!error && bestFrIters[btch].score() > run.score()) {
-            bestFrIters[btch] = run;
+          if (!error && move.score > drawingCp.score()) {
+            move.score = drawingCp.score();
+            move.grNd = n;
+            move.box = DBox();
+            extendCorridor(drawingCp, a, ggs[btch], &move.box);
           }
 
           // reset grid
-          for (auto ce : a->getAdjList()) run.eraseFromGrid(ce, ggs[btch]);
+          for (auto ce : a->getAdjList()) {
+            drawingCp.eraseFromGrid(ce, ggs[btch]);
+          }
           if (ggs[btch]->isSettled(a)) ggs[btch]->unSettleNd(a);
+
+          drawingCp.rollback();
         }
 
+        drawingCp.rollback();
+
         ggs[btch]->settleNd(const_cast<GridNode*>(ggs[btch]->getGrNdById(
                                 drawing.getGrNd(a)->pl().getId())),
                             a);
 
         // re-settle edges
         for (auto ce : a->getAdjList()) drawing.applyToGrid(ce, ggs[btch]);
+
+        if (move.grNd) {
+          // the region affected by this move, padded to also cover
+          // interactions between neighboring grid nodes
+          extendCorridor(drawing, a, ggs[btch], &move.box);
+          move.box = util::geo::pad(move.box, 2 * ggs[btch]->getCellSize());
+        }
       }
     }
 
-    size_t bestCore = 0;
-    double bestScore = std::numeric_limits<double>::infinity();
-    for (size_t i = 0; i < jobs; i++) {
-      if (bestFrIters[i].score() < bestScore) {
-        bestScore = bestFrIters[i].score();
-        bestCore = i;
-      }
+    // commit the moves best first, skipping moves whose region overlaps the
+    // region of an already committed move. Moves with disjoint regions do not
+    // influence each other, the order only depends on the scores and is
+    // therefore deterministic
+    std::vector<size_t> order;
+    for (size_t i = 0; i < moves.size(); i++) {
+      if (moves[i].grNd) order.push_back(i);
     }
 
-    double imp = (drawing.score() - bestFrIters[bestCore].score());
-    LOGTO(DEBUG, std::cerr)
-        << " ++ Iter " << iters << ", prev " << drawing.score() << ", next "
-        << bestFrIters[bestCore].score() << " (" << (imp >= 0 ? "+" : "") << imp
-        << ", " << T_STOP(iter) << " ms)";
+    std::sort(order.begin(), order.end(), [&moves](size_t a, size_t b) {
+      return moves[a].score < moves[b].score ||
+             (moves[a].score == moves[b].score && a < b);
+    });
+
+    Drawing prevDrawing = drawing;
+    std::vector<DBox> committed;
+
+    for (size_t i : order) {
+      bool conflict = false;
+      for (const auto& box : committed) {
+        if (util::geo::intersects(box, moves[i].box)) {
+          conflict = true;
+          break;
+        }
+      }
+      if (conflict) continue;
+
+      auto n = ggs[0]->getGrNdById(moves[i].grNd->pl().getId());
+
+      if (moveNd(locNds[i], n, ggs[0], &routers[0], &drawing, maxGrDist,
+                 geoPens)) {
+        committed.push_back(moves[i].box);
+      }
+    }
 
-    for (size_t i = 0; i < jobs; i++) {
-      drawing.eraseFromGrid(ggs[i]);
-      bestFrIters[bestCore].applyToGrid(ggs[i]);
+    // bring the other grid graphs up to date
+    if (committed.size()) {
+      for (size_t i = 1; i < jobs; i++) {
+        prevDrawing.eraseFromGrid(ggs[i]);
+        drawing.applyToGrid(ggs[i]);
+      }
     }
-    drawing = bestFrIters[bestCore];
+
+    double imp = (prevScore - drawing.score());
+    LOGTO(DEBUG, std::cerr)
+        << " ++ Iter " << iters << ", prev " << prevScore << ", next "
+        << drawing.score() << " (" << (imp >= 0 ? "+" : "") << imp << ", "
+        << committed.size() << " moves, " << T_STOP(iter) << " ms)";
 
     if (imp < CONVERGENCE_THRESHOLD) break;
   }
 
+  _stats.locSearchMs = T_STOP(locsearch);
+  _stats.locSearchIters = iters;
+  for (const auto& r : routers) _stats.routerQueries += r.numQueries();
+
   drawing.getLineGraph(outTg);
   auto fullScore = drawing.fullScore();
   LOGTO(DEBUG, std::cerr) << "Topo violations: " << drawing.violations()
@@ -346,16 +553,77 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
                           << ", mv costs: " << fullScore.move
                           << ", dense costs: " << fullScore.dense;
 
-  *retGg = ggs[0];
+  // only the first grid graph is handed out, the others are released
+  *retGg = ggs.take(0);
   *dOut = drawing;
 
   // the drawing might still have another internal grid graph, make sure they
   // match (this is important for drawILP)
-  dOut->setBaseGraph(ggs[0]);
+  dOut->setBaseGraph(*retGg);
+
   fullScore.iters = iters;
   return fullScore;
 }
 
+// _____________________________________________________________________________
+bool Octilinearizer::moveNd(CombNode* a, const GridNode* n, BaseGraph* gg,
+                            GridRouter* router, Drawing* drawing,
+                            double maxGrDist, const GeoPensMap* geoPens) {
+  double prevScore = drawing->score();
+  auto prevGrNd = const_cast<GridNode*>(
+      gg->getGrNdById(drawing->getGrNd(a)->pl().getId()));
+
+  drawing->checkpoint();
+
+  std::vector<CombEdge*> test;
+  for (auto ce : a->getAdjList()) {
+    test.push_back(ce);
+
+    drawing->eraseFromGrid(ce, gg);
+    drawing->erase(ce);
+  }
+
+  drawing->erase(a);
+  gg->unSettleNd(a);
+
+  SettledPos p;
+  p[a] = n;
+
+  auto error = draw(test, p, gg, router, drawing, prevScore, maxGrDist,
+                    geoPens, std::numeric_limits<size_t>::max());
+
+  if (!error && drawing->score() < prevScore) {
+    drawing->commit();
+    return true;
+  }
+
+  // revert
+  for (auto ce : a->getAdjList()) drawing->eraseFromGrid(ce, gg);
+  if (gg->isSettled(a)) gg->unSettleNd(a);
+
+  drawing->rollback();
+
+  gg->settleNd(prevGrNd, a);
+  for (auto ce : a->getAdjList()) drawing->applyToGrid(ce, gg);
+
+  return false;
+}
+
+// _____________________________________________________________________________
+void Octilinearizer::writeGeoPens(BaseGraph* gg,
+                                  const std::vector<CombEdge*>& edges,
+                                  double pen, GeoPensMap* target) const {
+  // create all entries first, the map is not modified while the penalties
+  // are written in parallel
+  std::vector<GeoPens*> pens(edges.size());
+  for (size_t i = 0; i < edges.size(); i++) pens[i] = &(*target)[edges[i]];
+
+#pragma omp parallel for schedule(dynamic) num_threads(_jobs)
+  for (size_t i = 0; i < edges.size(); i++) {
+    gg->writeGeoCoursePens(edges[i], pens[i], pen);
+  }
+}
+
 // _____________________________________________________________________________
 void Octilinearizer::settleRes(GridNode* frGrNd, GridNode* toGrNd,
                                BaseGraph* gg, CombNode* from, CombNode* to,
@@ -382,21 +650,44 @@ void Octilinearizer::writeNdCosts(GridNode* n, CombNode* origNode, CombEdge* e,
   g->addCostVec(n, c);
 }
 
+// _____________________________________________________________________________
+template <typename C>
+void Octilinearizer::route(GridRouter* router, const std::set<GridNode*>& from,
+                           const std::set<GridNode*>& to, const C& cost,
+                           const GrHeurFunc* heur, const GrHeurFunc* revHeur,
+                           GrEdgList* eL, GrNdList* nL) const {
+  // all octilinear and orthogonal grid graphs use GridGraphHeur
+  auto gridHeur = dynamic_cast<const GridGraphHeur*>(heur);
+  auto gridRevHeur = dynamic_cast<const GridGraphHeur*>(revHeur);
+
+  if (gridHeur && gridRevHeur) {
+    router->biShortestPath(from, to, cost, *gridHeur, *gridRevHeur, eL, nL);
+  } else if (gridHeur && !revHeur) {
+    router->shortestPath(from, to, cost, *gridHeur, eL, nL);
+  } else if (revHeur) {
+    router->biShortestPath(from, to, cost, *heur, *revHeur, eL, nL);
+  } else {
+    router->shortestPath(from, to, cost, *heur, eL, nL);
+  }
+}
+
 // _____________________________________________________________________________
 Undrawable Octilinearizer::draw(const std::vector<CombEdge*>& order,
-                                BaseGraph* gg, Drawing* drawing, double cutoff,
+                                BaseGraph* gg, GridRouter* router,
+                                Drawing* drawing, double cutoff,
                                 double maxGrDist, const GeoPensMap* geoPensMap,
                                 size_t abortAfter) {
   SettledPos emptyPos;
-  return draw(order, emptyPos, gg, drawing, cutoff, maxGrDist, geoPensMap,
-              abortAfter);
+  return draw(order, emptyPos, gg, router, drawing, cutoff, maxGrDist,
+              geoPensMap, abortAfter);
 }
 
 // _____________________________________________________________________________
 Undrawable Octilinearizer::draw(const std::vector<CombEdge*>& ord,
                                 const SettledPos& settled, BaseGraph* gg,
-                                Drawing* drawing, double globCutoff,
-                                double maxGrDist, const GeoPensMap* geoPensMap,
+                                GridRouter* router, Drawing* drawing,
+                                double globCutoff, double maxGrDist,
+                                const GeoPensMap* geoPensMap,
                                 size_t abortAfter) {
   SettledPos retPos;
 
@@ -480,19 +771,22 @@ Undrawable Octilinearizer::draw(const std::vector<CombEdge*>& ord,
     GridNode* toGrNd = 0;
     GridNode* frGrNd = 0;
 
+    // the heuristics read the sink costs, so sinks have to be open here
     auto heur = gg->getHeur(toGrNds);
+    auto revHeur = gg->getRevHeur(frGrNds);
 
     if (geoPensMap) {
       // init cost function with geo distance penalties
       auto cost = GridCostGeoPen(cutoff + costOffsetTo + costOffsetFrom,
                                  &geoPensMap->find(cmbEdg)->second);
-      Dijkstra::shortestPath(frGrNds, toGrNds, cost, *heur, &eL, &nL);
+      route(router, frGrNds, toGrNds, cost, heur, revHeur, &eL, &nL);
     } else {
       auto cost = GridCost(cutoff + costOffsetTo + costOffsetFrom);
-      Dijkstra::shortestPath(frGrNds, toGrNds, cost, *heur, &eL, &nL);
+      route(router, frGrNds, toGrNds, cost, heur, revHeur, &eL, &nL);
     }
 
     delete heur;
+    delete revHeur;
 
     if (!nL.size()) {
       // cleanup
@@ -630,27 +924,122 @@ BaseGraph* Octilinearizer::newBaseGraph(const DBox& bbox, const CombGraph& cg,
                                         double cellSize, double spacer,
                                         size_t hananIters,
                                         const Penalties& pens) const {
+  // candidates are taken out of the pool under the lock, but re-windowed
+  // after releasing it, as re-windowing is linear in the grid size
+  std::vector<PooledGraph> rejected;
+  BaseGraph* gg = 0;
+
+  while (!gg) {
+    PooledGraph cand;
+    cand.gg = 0;
+
+    {
+      std::lock_guard<std::mutex> lock(graphPool.mutex);
+      auto& graphs = graphPool.graphs;
+      for (size_t i = 0; i < graphs.size(); i++) {
+        if (graphs[i].type != _baseGraphType || graphs[i].spacer != spacer ||
+            graphs[i].gg->getCellSize() != cellSize ||
+            !samePens(graphs[i].gg->getPens(), pens)) {
+          continue;
+        }
+        cand = graphs[i];
+        graphPool.bytes -= cand.bytes;
+        graphs.erase(graphs.begin() + i);
+        break;
+      }
+    }
+
+    if (!cand.gg) break;
+
+    if (cand.gg->reWindow(bbox)) {
+      gg = cand.gg;
+    } else {
+      rejected.push_back(cand);
+    }
+  }
+
+  if (rejected.size()) {
+    std::lock_guard<std::mutex> lock(graphPool.mutex);
+    for (const auto& p : rejected) graphPool.bytes += p.bytes;
+    graphPool.graphs.insert(graphPool.graphs.end(), rejected.begin(),
+                            rejected.end());
+  }
+
+  if (gg) return gg;
+
   switch (_baseGraphType) {
     case OCTIGRID:
-      return new OctiGridGraph(bbox, cellSize, spacer, pens);
+      gg = new OctiGridGraph(bbox, cellSize, spacer, pens);
+      break;
     case CONVEXHULLOCTIGRID:
-      return new ConvexHullOctiGridGraph(hull(cg), bbox, cellSize, spacer,
-                                         pens);
+      gg = new ConvexHullOctiGridGraph(hull(cg), bbox, cellSize, spacer, pens);
+      break;
     case GRID:
-      return new GridGraph(bbox, cellSize, spacer, pens);
+      gg = new GridGraph(bbox, cellSize, spacer, pens);
+      break;
     case ORTHORADIAL:
-      return new OrthoRadialGraph(bbox, cellSize, spacer, pens);
+      gg = new OrthoRadialGraph(bbox, cellSize, spacer, pens);
+      break;
     case PSEUDOORTHORADIAL:
-      return new PseudoOrthoRadialGraph(bbox, cellSize, spacer, pens);
+      gg = new PseudoOrthoRadialGraph(bbox, cellSize, spacer, pens);
+      break;
     case OCTIHANANGRID:
-      return new OctiHananGraph(bbox, cg, cellSize, spacer, hananIters, pens);
+      gg = new OctiHananGraph(bbox, cg, cellSize, spacer, hananIters, pens);
+      break;
     case OCTIQUADTREE:
-      return new OctiQuadTree(bbox, cg, cellSize, spacer, pens);
+      gg = new OctiQuadTree(bbox, cg, cellSize, spacer, pens);
+      break;
     case HEXGRID:
-      return new HexGridGraph(bbox, cellSize, spacer, pens);
+      gg = new HexGridGraph(bbox, cellSize, spacer, pens);
+      break;
+    case SPARSEOCTIGRID:
+      gg = new SparseOctiGridGraph(bbox, cellSize, spacer, pens);
+      break;
     default:
       return 0;
   }
+
+  gg->init();
+  return gg;
+}
+
+// _____________________________________________________________________________
+void Octilinearizer::releaseBaseGraph(BaseGraph* gg, double spacer) const {
+  if (!gg) return;
+
+  // graphs which can never be moved are of no use to later drawings
+  if (_baseGraphType != OCTIGRID && _baseGraphType != GRID) {
+    delete gg;
+    return;
+  }
+
+  // estimated outside of the lock, this is linear in the grid size
+  size_t bytes = graphBytes(gg);
+
+  std::vector<BaseGraph*> evicted;
+
+  {
+    std::lock_guard<std::mutex> lock(graphPool.mutex);
+    auto& graphs = graphPool.graphs;
+    graphs.push_back({_baseGraphType, spacer, gg, bytes});
+    graphPool.bytes += bytes;
+
+    // evict the oldest graphs first, a single graph above the limit is
+    // never kept
+    while (graphPool.bytes > MAX_POOL_BYTES) {
+      evicted.push_back(graphs.front().gg);
+      graphPool.bytes -= graphs.front().bytes;
+      graphs.erase(graphs.begin());
+    }
+  }
+
+  for (auto gg : evicted) delete gg;
+}
+
+// _____________________________________________________________________________
+void Octilinearizer::clearBaseGraphPool() {
+  std::lock_guard<std::mutex> lock(graphPool.mutex);
+  graphPool.clear();
 }
 
 // _____________________________________________________________________________
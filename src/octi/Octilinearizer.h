@@ -5,12 +5,15 @@
 #ifndef OCTI_OCTILINEARIZER_H_
 #define OCTI_OCTILINEARIZER_H_
 
+#include <atomic>
+#include <limits>
 #include <unordered_set>
 #include <vector>
 
 #include "ilp/ILPGridOptimizer.h"
 #include "octi/basegraph/BaseGraph.h"
 #include "octi/basegraph/GridGraph.h"
+#include "octi/basegraph/GridRouter.h"
 #include "octi/combgraph/CombGraph.h"
 #include "octi/combgraph/Drawing.h"
 #include "octi/config/OctiConfig.h"
@@ -27,6 +30,7 @@ using octi::basegraph::GridEdgePL;
 using octi::basegraph::GridGraph;
 using octi::basegraph::GridNode;
 using octi::basegraph::GridNodePL;
+using octi::basegraph::GridRouter;
 using octi::basegraph::NodeCost;
 using octi::basegraph::Penalties;
 
@@ -48,9 +52,30 @@ typedef util::graph::EList<GridNodePL, GridEdgePL> GrEdgList;
 typedef util::graph::NList<GridNodePL, GridEdgePL> GrNdList;
 typedef std::pair<std::set<GridNode*>, std::set<GridNode*>> RtPair;
 typedef std::map<CombNode*, const GridNode*> SettledPos;
+typedef util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>
+    GrHeurFunc;
 
 enum Undrawable { DRAWN = 0, NO_PATH = 1, NO_CANDS = 2 };
 
+// best move of a single node found by the local search
+struct LocSearchMove {
+  double score = std::numeric_limits<double>::infinity();
+  const GridNode* grNd = 0;
+
+  // region of the grid affected by the move
+  util::geo::DBox box;
+};
+
+// timings and counts of the last heuristic drawing
+struct DrawStats {
+  double gridMs = 0;
+  double geoPensMs = 0;
+  double initialMs = 0;
+  double locSearchMs = 0;
+  size_t routerQueries = 0;
+  size_t locSearchIters = 0;
+};
+
 // exception thrown when no planar embedding could be found
 struct NoEmbeddingFoundExc : public std::exception {
   const char* what() const throw() {
@@ -58,6 +83,11 @@ struct NoEmbeddingFoundExc : public std::exception {
   }
 };
 
+// exception thrown when a drawing was cancelled from outside
+struct DrawingCancelledExc : public std::exception {
+  const char* what() const throw() { return "Drawing was cancelled."; }
+};
+
 // comparator for nodes, based on degree
 struct NodeCmpDeg {
   bool operator()(const CombNode* a, const CombNode* b) {
@@ -130,7 +160,7 @@ struct GraphMeasures {
   size_t maxDeg;
 };
 
-struct GridCost
+struct GridCost final
     : public util::graph::Dijkstra::CostFunc<GridNodePL, GridEdgePL, float> {
   GridCost(float inf) : _inf(inf) {}
   virtual float operator()(const GridNode* from, const GridEdge* e,
@@ -145,7 +175,7 @@ struct GridCost
   virtual float inf() const { return _inf; }
 };
 
-struct GridCostGeoPen
+struct GridCostGeoPen final
     : public Dijkstra::CostFunc<GridNodePL, GridEdgePL, float> {
   GridCostGeoPen(float inf, const GeoPens* geoPens)
       : _inf(inf), _geoPens(geoPens) {}
@@ -157,11 +187,8 @@ struct GridCostGeoPen
     // ignore geopens for secondary edges
     if (e->pl().isSecondary()) return e->pl().cost();
 
-    auto i = (*_geoPens).find(e->pl().getId());
-    if (i != _geoPens->end()) return e->pl().cost() + i->second;
-
-    // if no geopen was present for grid edge, we assume SOFT_INF penalty
-    return e->pl().cost() + octi::basegraph::SOFT_INF;
+    // if no geopen was present for grid edge, this is SOFT_INF
+    return e->pl().cost() + _geoPens->get(e);
   }
 
   float _inf;
@@ -173,7 +200,27 @@ struct GridCostGeoPen
 class Octilinearizer {
  public:
   Octilinearizer(basegraph::BaseGraphType baseGraphType)
-      : _baseGraphType(baseGraphType) {}
+      : Octilinearizer(baseGraphType, 0) {}
+
+  // jobs is the number of parallel workers (each with its own grid graph)
+  // used by the heuristic drawing, 0 means the number of available cores,
+  // but at most 4
+  Octilinearizer(basegraph::BaseGraphType baseGraphType, size_t jobs);
+
+  // if set, the heuristic drawing regularly checks cancel and throws a
+  // DrawingCancelledExc once it becomes true
+  void setCancelFlag(const std::atomic<bool>* cancel) { _cancel = cancel; }
+
+  const DrawStats& getStats() const { return _stats; }
+
+  // hand a grid graph created by this octilinearizer back once it is no
+  // longer needed, it may then be reused by later drawings (also of other
+  // octilinearizers) with the same grid. spacer is the border radius the
+  // graph was drawn with.
+  void releaseBaseGraph(basegraph::BaseGraph* gg, double spacer) const;
+
+  // free all grid graphs kept for reuse, call once no more drawings follow
+  static void clearBaseGraphPool();
 
   Score draw(const CombGraph& cg, const util::geo::DBox& box, LineGraph* out,
              basegraph::BaseGraph** gg, Drawing* d, const Penalties& pens,
@@ -187,7 +234,8 @@ class Octilinearizer {
                 basegraph::BaseGraph** gg, Drawing* d, const Penalties& pens,
                 double gridSize, double borderRad, double maxGrDist,
                 config::OrderMethod orderMethod, bool noSolve,
-                double enfGeoPens, size_t hananIters, int timeLim,
+                double enfGeoPens, size_t hananIters, double corridorRad,
+                size_t corridorIters, double pruneSlack, int timeLim,
                 const std::string& cacheDir, double cacheThreshold,
                 int numThreads, octi::ilp::ILPStats* stats,
                 const std::string& solverStr, const std::string& path);
@@ -196,7 +244,13 @@ class Octilinearizer {
 
  private:
   basegraph::BaseGraphType _baseGraphType;
+  size_t _jobs;
+  const std::atomic<bool>* _cancel;
+  DrawStats _stats;
+
+  bool cancelled() const { return _cancel && *_cancel; }
 
+  // returns an initialized grid graph, possibly a reused one
   basegraph::BaseGraph* newBaseGraph(const util::geo::DBox& bbox,
                                      const CombGraph& cg, double cellSize,
                                      double spacer, size_t hananIters,
@@ -204,9 +258,19 @@ class Octilinearizer {
 
   util::geo::Polygon<double> hull(const CombGraph& cg) const;
 
+  void writeGeoPens(basegraph::BaseGraph* gg,
+                    const std::vector<CombEdge*>& edges, double pen,
+                    GeoPensMap* target) const;
+
   void writeNdCosts(GridNode* n, CombNode* origNode, CombEdge* e,
                     basegraph::BaseGraph* g);
 
+  // move a to grid node n and redraw its adjacent edges, the move is only
+  // kept if it improves the drawing
+  bool moveNd(CombNode* a, const GridNode* n, basegraph::BaseGraph* gg,
+              GridRouter* router, Drawing* drawing, double maxGrDist,
+              const GeoPensMap* geoPens);
+
   void settleRes(GridNode* startGridNd, GridNode* toGridNd,
                  basegraph::BaseGraph* gg, CombNode* from, CombNode* to,
                  const GrEdgList& res, CombEdge* e);
@@ -217,12 +281,22 @@ class Octilinearizer {
                                      octi::config::OrderMethod method) const;
 
   Undrawable draw(const std::vector<CombEdge*>& order, basegraph::BaseGraph* gg,
-                  Drawing* drawing, double cutoff, double maxGrDist,
-                  const GeoPensMap* geoPensMap, size_t abortAfter);
+                  GridRouter* router, Drawing* drawing, double cutoff,
+                  double maxGrDist, const GeoPensMap* geoPensMap,
+                  size_t abortAfter);
   Undrawable draw(const std::vector<CombEdge*>& order,
                   const SettledPos& settled, basegraph::BaseGraph* gg,
-                  Drawing* drawing, double cutoff, double maxGrDist,
-                  const GeoPensMap* geoPensMap, size_t abortAfter);
+                  GridRouter* router, Drawing* drawing, double cutoff,
+                  double maxGrDist, const GeoPensMap* geoPensMap,
+                  size_t abortAfter);
+
+  // route with the concrete heuristic types if they are known, so the
+  // router can inline the heuristic calls. revHeur may be 0.
+  template <typename C>
+  void route(GridRouter* router, const std::set<GridNode*>& from,
+             const std::set<GridNode*>& to, const C& cost,
+             const GrHeurFunc* heur, const GrHeurFunc* revHeur,
+             GrEdgList* eL, GrNdList* nL) const;
 
   SettledPos neigh(const SettledPos& pos, const std::vector<CombNode*>&,
                    size_t i) const;
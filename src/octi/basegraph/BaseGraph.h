@@ -4,9 +4,15 @@
 #ifndef OCTI_BASEGRAPH_BASEGRAPH_H_
 #define OCTI_BASEGRAPH_BASEGRAPH_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <map>
 #include <queue>
 #include <set>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include "octi/basegraph/GridEdgePL.h"
 #include "octi/basegraph/GridNodePL.h"
 #include "octi/basegraph/NodeCost.h"
@@ -40,7 +46,8 @@ enum BaseGraphType {
   ORTHORADIAL,
   PSEUDOORTHORADIAL,
   OCTIHANANGRID,
-  OCTIQUADTREE
+  OCTIQUADTREE,
+  SPARSEOCTIGRID
 };
 
 typedef util::graph::Node<GridNodePL, GridEdgePL> GridNode;
@@ -49,8 +56,57 @@ typedef util::graph::Edge<GridNodePL, GridEdgePL> GridEdge;
 typedef std::pair<const GridEdge*, const GridEdge*> EdgPair;
 typedef std::vector<std::pair<EdgPair, EdgPair>> CrossEdgPairs;
 
-// edge-id -> pen
-typedef std::unordered_map<uint32_t, float> GeoPens;
+// Geo course penalties of a single comb edge, stored densely over a window
+// of grid cells. A grid edge is addressed by the cell of its source port and
+// the index of that port. All grid edges without a penalty get a penalty of
+// SOFT_INF.
+class GeoPens {
+ public:
+  // reset to the cells [xMin, xMax] x [yMin, yMax] with maxDeg ports each,
+  // all penalties are then SOFT_INF
+  void reset(size_t xMin, size_t yMin, size_t xMax, size_t yMax,
+             size_t maxDeg) {
+    _x0 = xMin;
+    _y0 = yMin;
+    _w = xMax - xMin + 1;
+    _h = yMax - yMin + 1;
+    _deg = maxDeg;
+    _pens.assign(_w * _h * _deg, SOFT_INF);
+  }
+
+  // set the penalty of the grid edge leaving port i of cell (x, y), the cell
+  // must be inside the window
+  void set(size_t x, size_t y, size_t i, float pen) {
+    _pens[((x - _x0) * _h + (y - _y0)) * _deg + i] = pen;
+  }
+
+  void set(const GridEdge* e, float pen) {
+    auto port = e->getFrom();
+    const auto& cell = port->pl().getParent()->pl();
+    set(cell.getX(), cell.getY(), port->pl().getPortIdx(), pen);
+  }
+
+  float get(const GridEdge* e) const {
+    auto port = e->getFrom();
+    const auto& cell = port->pl().getParent()->pl();
+
+    // cells left of or below the window wrap around
+    size_t x = cell.getX() - _x0;
+    size_t y = cell.getY() - _y0;
+    if (x >= _w || y >= _h) return SOFT_INF;
+
+    return _pens[(x * _h + y) * _deg + port->pl().getPortIdx()];
+  }
+
+ private:
+  size_t _x0 = 0;
+  size_t _y0 = 0;
+  size_t _w = 0;
+  size_t _h = 0;
+  size_t _deg = 0;
+  std::vector<float> _pens;
+};
+
 typedef std::map<const CombEdge*, GeoPens> GeoPensMap;
 
 struct Candidate {
@@ -93,6 +149,12 @@ class BaseGraph : public DirGraph<GridNodePL, GridEdgePL> {
   virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
   getHeur(const std::set<GridNode*>& to) const = 0;
 
+  // heuristic for searching backwards from the targets, estimating the cost
+  // of reaching a node from any node in from. 0 if not available, the caller
+  // takes ownership.
+  virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
+  getRevHeur(const std::set<GridNode*>& from) const = 0;
+
   virtual std::priority_queue<Candidate> getGridNdCands(
       const util::geo::DPoint& p, size_t maxGrD) const = 0;
 
@@ -125,6 +187,15 @@ class BaseGraph : public DirGraph<GridNodePL, GridEdgePL> {
   virtual GridEdge* getNEdg(const GridNode* a, const GridNode* b) const = 0;
   virtual void reset() = 0;
 
+  // move the graph to bbox and reset it, without rebuilding its nodes and
+  // edges. Returns false (and leaves the graph untouched) if the graph
+  // cannot be moved to bbox.
+  virtual bool reWindow(const util::geo::DBox& bbox) = 0;
+
+  // make sure all edges adjacent to n exist, called by the router before it
+  // expands n. Only has an effect on graphs whose nodes are written on demand.
+  virtual void expand(const GridNode* n) = 0;
+
   virtual GridNode* getSettled(const CombNode* cnd) const = 0;
   virtual bool unused(const GridNode* gnd) const = 0;
 
@@ -138,7 +209,9 @@ class BaseGraph : public DirGraph<GridNodePL, GridEdgePL> {
   virtual std::set<CombEdge*> getResEdgs(const GridEdge* ge) const = 0;
   virtual std::set<CombEdge*> getResEdgsDirInd(const GridEdge* ge) const = 0;
 
-  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPensMap* target,
+  // write the geo course penalties of ce into target, may be called
+  // concurrently for different comb edges
+  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPens* target,
                                   double pen) = 0;
 
   virtual CrossEdgPairs getCrossEdgPairs() const = 0;
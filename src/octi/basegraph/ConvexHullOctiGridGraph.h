@@ -20,6 +20,11 @@ class ConvexHullOctiGridGraph : public OctiGridGraph {
       : OctiGridGraph(bbox, cellSize, spacer, pens), _hull(hull) {
   }
   virtual void init();
+  // cells are skipped based on the input hull, never moved
+  virtual bool reWindow(const util::geo::DBox& bbox) {
+    UNUSED(bbox);
+    return false;
+  }
 
  protected:
   virtual bool skip(size_t x, size_t y) const;
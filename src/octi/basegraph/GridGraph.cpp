@@ -50,6 +50,9 @@ GridGraph::GridGraph(const DBox& bbox, double cellSize, double spacer,
 
 // _____________________________________________________________________________
 void GridGraph::init() {
+  // every cell holds a center node and one port per direction
+  _nds.reserve(_grid.getXWidth() * _grid.getYHeight() * (maxDeg() + 1));
+
   // write nodes
   for (size_t x = 0; x < _grid.getXWidth(); x++) {
     for (size_t y = 0; y < _grid.getYHeight(); y++) {
@@ -181,9 +184,9 @@ void GridGraph::writeObstacleCost(const util::geo::Polygon<double>& obst) {
 }
 
 // _____________________________________________________________________________
-void GridGraph::writeGeoCoursePens(const CombEdge* ce, GeoPensMap* target,
+void GridGraph::writeGeoCoursePens(const CombEdge* ce, GeoPens* target,
                                    double pen) {
-  std::set<GridNode*> neighs;
+  std::vector<GridNode*> neighs;
 
   DBox box;
 
@@ -197,7 +200,21 @@ void GridGraph::writeGeoCoursePens(const CombEdge* ce, GeoPensMap* target,
   }
 
   box = util::geo::pad(box, sqrt(SOFT_INF / pen) * getCellSize());
-  _grid.get(box, &neighs);
+  getGrNdsInBox(box, &neighs);
+
+  *target = GeoPens();
+  if (neighs.empty()) return;
+
+  size_t xMin = std::numeric_limits<size_t>::max(), xMax = 0;
+  size_t yMin = std::numeric_limits<size_t>::max(), yMax = 0;
+  for (auto grNd : neighs) {
+    xMin = std::min(xMin, grNd->pl().getX());
+    xMax = std::max(xMax, grNd->pl().getX());
+    yMin = std::min(yMin, grNd->pl().getY());
+    yMax = std::max(yMax, grNd->pl().getY());
+  }
+
+  target->reset(xMin, yMin, xMax, yMax, maxDeg());
 
   for (auto grNdA : neighs) {
     for (size_t i = 0; i < maxDeg(); i++) {
@@ -221,7 +238,7 @@ void GridGraph::writeGeoCoursePens(const CombEdge* ce, GeoPensMap* target,
 
       d *= pen * d;
 
-      if (d <= SOFT_INF) (*target)[ce][ge->pl().getId()] = d;
+      if (d <= SOFT_INF) target->set(ge, d);
     }
   }
 }
@@ -532,14 +549,14 @@ void GridGraph::writeInitialCosts() {
 std::priority_queue<Candidate> GridGraph::getGridNdCands(const DPoint& p,
                                                          size_t maxGrD) const {
   std::priority_queue<Candidate> ret;
-  std::set<GridNode*> neigh;
+  std::vector<GridNode*> neigh;
 
   double maxD = getCellSize() * maxGrD;
 
   DBox b(DPoint(p.getX() - maxD, p.getY() - maxD),
          DPoint(p.getX() + maxD, p.getY() + maxD));
 
-  _grid.get(b, &neigh);
+  getGrNdsInBox(b, &neigh);
 
   for (auto n : neigh) {
     if (n->pl().isClosed() || n->pl().isSettled()) continue;
@@ -551,6 +568,14 @@ std::priority_queue<Candidate> GridGraph::getGridNdCands(const DPoint& p,
   return ret;
 }
 
+// _____________________________________________________________________________
+void GridGraph::getGrNdsInBox(const DBox& box,
+                              std::vector<GridNode*>* ret) const {
+  std::set<GridNode*> tmp;
+  _grid.get(box, &tmp);
+  ret->insert(ret->end(), tmp.begin(), tmp.end());
+}
+
 // _____________________________________________________________________________
 const Grid<GridNode*, Point, double>& GridGraph::getGrid() const {
   return _grid;
@@ -587,6 +612,12 @@ GridGraph::getHeur(const std::set<GridNode*>& to) const {
   return new GridGraphHeur(this, to);
 }
 
+// _____________________________________________________________________________
+const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
+GridGraph::getRevHeur(const std::set<GridNode*>& from) const {
+  return new GridGraphHeur(this, from, true);
+}
+
 // _____________________________________________________________________________
 void GridGraph::openTurns(GridNode* n) {
   if (!n->pl().isClosed()) return;
@@ -724,37 +755,16 @@ const GridEdge* GridGraph::getGrEdgById(std::pair<size_t, size_t> id) const {
 
 // _____________________________________________________________________________
 GridNode* GridGraph::writeNd(size_t x, size_t y) {
-  double xPos = _bbox.getLowerLeft().getX() + x * _cellSize;
-  double yPos = _bbox.getLowerLeft().getY() + y * _cellSize;
-
-  GridNode* n = addNd(DPoint(xPos, yPos));
-  n->pl().setId(_nds.size());
-  _nds.push_back(n);
+  GridNode* n = addNd(ndGeom(x, y));
+  regNd(n);
   n->pl().setSink();
-  _grid.add(x, y, n);
+  indexNd(x, y, n);
   n->pl().setXY(x, y);
   n->pl().setParent(n);
 
   for (int i = 0; i < 4; i++) {
-    int xi = 0;
-    int yi = 0;
-
-    if (i == 0) {
-      yi = 1;
-    }
-    if (i == 1) {
-      xi = 1;
-    }
-    if (i == 2) {
-      yi = -1;
-    }
-    if (i == 3) {
-      xi = -1;
-    }
-
-    GridNode* nn = addNd(DPoint(xPos + xi * _spacer, yPos + yi * _spacer));
-    nn->pl().setId(_nds.size());
-    _nds.push_back(nn);
+    GridNode* nn = addNd(portGeom(x, y, i));
+    regNd(nn);
     nn->pl().setParent(n);
     n->pl().setPort(i, nn);
 
@@ -792,6 +802,45 @@ GridNode* GridGraph::writeNd(size_t x, size_t y) {
   return n;
 }
 
+// _____________________________________________________________________________
+DPoint GridGraph::ndGeom(size_t x, size_t y) const {
+  return DPoint(_bbox.getLowerLeft().getX() + x * _cellSize,
+                _bbox.getLowerLeft().getY() + y * _cellSize);
+}
+
+// _____________________________________________________________________________
+DPoint GridGraph::portGeom(size_t x, size_t y, size_t i) const {
+  int xi = 0;
+  int yi = 0;
+
+  if (i == 0) {
+    yi = 1;
+  }
+  if (i == 1) {
+    xi = 1;
+  }
+  if (i == 2) {
+    yi = -1;
+  }
+  if (i == 3) {
+    xi = -1;
+  }
+
+  DPoint p = ndGeom(x, y);
+  return DPoint(p.getX() + xi * _spacer, p.getY() + yi * _spacer);
+}
+
+// _____________________________________________________________________________
+void GridGraph::indexNd(size_t x, size_t y, GridNode* n) {
+  _grid.add(x, y, n);
+}
+
+// _____________________________________________________________________________
+void GridGraph::regNd(GridNode* n) {
+  n->pl().setId(_nds.size());
+  _nds.push_back(n);
+}
+
 // _____________________________________________________________________________
 double GridGraph::ndMovePen(const CombNode* cbNd, const GridNode* grNd) const {
   // the move penalty has to be at least the max cost of saving a single
@@ -831,6 +880,55 @@ void GridGraph::reset() {
   reWriteObstCosts();
 }
 
+// _____________________________________________________________________________
+bool GridGraph::reWindow(const DBox& bbox) {
+  // only possible if bbox results in the same grid dimensions, the topology
+  // of the graph is then identical and only the node positions move
+  Grid<GridNode*, Point, double> grid(_cellSize, _cellSize, bbox, false);
+  if (grid.getXWidth() != _grid.getXWidth() ||
+      grid.getYHeight() != _grid.getYHeight()) {
+    return false;
+  }
+
+  _bbox = bbox;
+  _grid = grid;
+  _obstacles.clear();
+
+  for (auto n : getNds()) {
+    n->pl().setSettled(false);
+
+    // a previous drawing may have left edges closed or blocked
+    for (auto e : n->getAdjListOut()) {
+      e->pl().open();
+      e->pl().unblock();
+    }
+
+    if (!n->pl().isSink()) continue;
+
+    // recompute the positions exactly as writeNd() does, so a moved graph
+    // is indistinguishable from a freshly built one
+    size_t x = n->pl().getX();
+    size_t y = n->pl().getY();
+    n->pl().setGeom(ndGeom(x, y));
+    for (size_t i = 0; i < maxDeg(); i++) {
+      auto port = n->pl().getPort(i);
+      if (port) port->pl().setGeom(portGeom(x, y, i));
+    }
+
+    indexNd(x, y, n);
+  }
+
+  reset();
+
+  return true;
+}
+
+// _____________________________________________________________________________
+void GridGraph::expand(const GridNode* n) {
+  // all nodes and edges are written by init()
+  UNUSED(n);
+}
+
 // _____________________________________________________________________________
 void GridGraph::reWriteObstCosts() {
   for (const auto& obst : _obstacles) writeObstacleCost(obst);
@@ -74,6 +74,8 @@ class GridGraph : public BaseGraph {
   virtual GridEdge* getNEdg(const GridNode* a, const GridNode* b) const;
   virtual void init();
   virtual void reset();
+  virtual bool reWindow(const util::geo::DBox& bbox);
+  virtual void expand(const GridNode* n);
 
   virtual GridNode* getSettled(const CombNode* cnd) const;
 
@@ -87,13 +89,15 @@ class GridGraph : public BaseGraph {
 
   virtual CrossEdgPairs getCrossEdgPairs() const;
 
-  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPensMap* target,
+  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPens* target,
                                   double pen);
 
   virtual void addObstacle(const util::geo::Polygon<double>& obst);
 
   virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
   getHeur(const std::set<GridNode*>& to) const;
+  virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
+  getRevHeur(const std::set<GridNode*>& from) const;
 
   virtual PolyLine<double> geomFromPath(
       const std::vector<std::pair<size_t, size_t>>& res) const;
@@ -132,8 +136,23 @@ class GridGraph : public BaseGraph {
 
   virtual GridNode* getNode(size_t x, size_t y) const;
 
+  // write (at least) all grid nodes whose geometry lies in box into ret, ports
+  // are never written
+  virtual void getGrNdsInBox(const util::geo::DBox& box,
+                             std::vector<GridNode*>* ret) const;
+
   virtual GridNode* writeNd(size_t x, size_t y);
 
+  // position of the grid node of cell (x, y), and of its port i
+  virtual util::geo::DPoint ndGeom(size_t x, size_t y) const;
+  virtual util::geo::DPoint portGeom(size_t x, size_t y, size_t i) const;
+
+  // add the grid node of cell (x, y) to the geometric cell index
+  virtual void indexNd(size_t x, size_t y, GridNode* n);
+
+  // give n the next node id
+  virtual void regNd(GridNode* n);
+
   virtual GridNode* neigh(size_t cx, size_t cy, size_t i) const;
 
   virtual void getSettledAdjEdgs(GridNode* n, CombNode* origNd,
@@ -163,10 +182,14 @@ struct GridCost
   virtual float inf() const { return _inf; }
 };
 
-struct GridGraphHeur
+struct GridGraphHeur final
     : public util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float> {
-  GridGraphHeur(const basegraph::GridGraph* g, const std::set<GridNode*>& to)
-      : g(g) {
+  // if rev is set, the heuristic estimates the cost of reaching a node from
+  // any node in to (for searching backwards), and the cheapest outgoing
+  // sink edge is used
+  GridGraphHeur(const basegraph::GridGraph* g, const std::set<GridNode*>& to,
+                bool rev = false)
+      : g(g), rev(rev) {
     cheapestSink = std::numeric_limits<float>::infinity();
 
     for (auto n : to) {
@@ -174,7 +197,7 @@ struct GridGraphHeur
       size_t i = 0;
       for (; i < g->maxDeg(); i++) {
         if (!n->pl().getPort(i)) continue;
-        float sinkCost = g->getEdg(n->pl().getPort(i), n)->pl().cost();
+        float sinkCost = sinkEdg(n, i)->pl().cost();
         if (sinkCost < cheapestSink) cheapestSink = sinkCost;
         auto neigh = g->neigh(n, i);
         if (neigh && to.find(neigh) == to.end()) {
@@ -185,7 +208,7 @@ struct GridGraphHeur
       }
       for (size_t j = i; j < g->maxDeg(); j++) {
         if (!n->pl().getPort(j)) continue;
-        float sinkCost = g->getEdg(n->pl().getPort(j), n)->pl().cost();
+        float sinkCost = sinkEdg(n, j)->pl().cost();
         if (sinkCost < cheapestSink) cheapestSink = sinkCost;
       }
     }
@@ -206,7 +229,13 @@ struct GridGraphHeur
     return ret + cheapestSink;
   }
 
+  const GridEdge* sinkEdg(const GridNode* n, size_t port) const {
+    if (rev) return g->getEdg(n, n->pl().getPort(port));
+    return g->getEdg(n->pl().getPort(port), n);
+  }
+
   const octi::basegraph::BaseGraph* g;
+  bool rev;
   std::vector<size_t> hull;
   float cheapestSink;
 };
@@ -2,6 +2,7 @@
 // Chair of Algorithms and Data Structures.
 // Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
+#include <algorithm>
 #include "octi/basegraph/GridNodePL.h"
 
 using util::geo::Point;
@@ -9,11 +10,19 @@ using namespace octi::basegraph;
 
 // _____________________________________________________________________________
 GridNodePL::GridNodePL(Point<double> pos)
-    : _pos(pos), _parent(0), _closed(false), _sink(false), _settled(false) {}
+    : _pos(pos),
+      _parent(0),
+      _closed(false),
+      _sink(false),
+      _settled(false),
+      _portIdx(0) {}
 
 // _____________________________________________________________________________
 const Point<double>* GridNodePL::getGeom() const { return &_pos; }
 
+// _____________________________________________________________________________
+void GridNodePL::setGeom(const Point<double>& pos) { _pos = pos; }
+
 // _____________________________________________________________________________
 util::json::Dict GridNodePL::getAttrs() const {
   util::json::Dict obj;
@@ -34,10 +43,21 @@ GridNode* GridNodePL::getParent() const { return _parent; }
 void GridNodePL::setParent(GridNode* n) { _parent = n; }
 
 // _____________________________________________________________________________
-GridNode* GridNodePL::getPort(size_t i) const { return _ports[i]; }
+GridNode* GridNodePL::getPort(size_t i) const {
+  if (i >= _ports.size()) return 0;
+  return _ports[i];
+}
+
+// _____________________________________________________________________________
+void GridNodePL::setPort(size_t p, GridNode* n) {
+  // no base graph has more than 8 ports per node
+  if (p >= _ports.size()) _ports.resize(std::max<size_t>(p + 1, 8), 0);
+  _ports[p] = n;
+  if (n) n->pl()._portIdx = p;
+}
 
 // _____________________________________________________________________________
-void GridNodePL::setPort(size_t p, GridNode* n) { _ports[p] = n; }
+size_t GridNodePL::getPortIdx() const { return _portIdx; }
 
 // _____________________________________________________________________________
 void GridNodePL::setXY(size_t x, size_t y) {
@@ -5,6 +5,7 @@
 #ifndef OCTI_BASEGRAPH_GRIDNODEPL_H_
 #define OCTI_BASEGRAPH_GRIDNODEPL_H_
 
+#include <vector>
 #include "octi/basegraph/GridEdgePL.h"
 #include "util/geo/Geo.h"
 #include "util/geo/GeoGraph.h"
@@ -26,6 +27,7 @@ class GridNodePL : util::geograph::GeoNodePL<double> {
   GridNodePL(Point<double> pos);
 
   const Point<double>* getGeom() const;
+  void setGeom(const Point<double>& pos);
   util::json::Dict getAttrs() const;
 
   GridNode* getParent() const;
@@ -34,6 +36,9 @@ class GridNodePL : util::geograph::GeoNodePL<double> {
   GridNode* getPort(size_t i) const;
   void setPort(size_t p, GridNode* n);
 
+  // index of this port at its parent, 0 for grid nodes
+  size_t getPortIdx() const;
+
   void setXY(size_t x, size_t y);
   size_t getX() const;
   size_t getY() const;
@@ -54,13 +59,16 @@ class GridNodePL : util::geograph::GeoNodePL<double> {
   Point<double> _pos;
 
   GridNode* _parent;
-  GridNode* _ports[8];
+
+  // only grid nodes have ports, empty for the ports themselves
+  std::vector<GridNode*> _ports;
 
   uint32_t _x, _y;
   uint32_t _id;
   bool _closed : 1;
   bool _sink : 1;
   bool _settled : 1;
+  uint8_t _portIdx : 3;
 };
 }  // namespace basegraph
 }  // namespace octi
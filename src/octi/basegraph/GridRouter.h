@@ -0,0 +1,330 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef OCTI_BASEGRAPH_GRIDROUTER_H_
+#define OCTI_BASEGRAPH_GRIDROUTER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <vector>
+#include "octi/basegraph/BaseGraph.h"
+#include "util/graph/Dijkstra.h"
+
+namespace octi {
+namespace basegraph {
+
+// A* search on base graphs, specialised for routing comb edges. The search
+// state is indexed by grid node id and kept between queries, it is
+// invalidated by a generation counter instead of being cleared. A router may
+// only be used by one thread at a time.
+//
+// Settled nodes are re-opened if a shorter path to them is found, which can
+// only happen if a heuristic is admissible but not consistent. Searches are
+// thus exact for admissible heuristics.
+class GridRouter {
+ public:
+  GridRouter()
+      : _gg(0),
+        _gen(0),
+        _numQueries(0),
+        _bidir(false),
+        _best(std::numeric_limits<float>::infinity()),
+        _meet(0) {}
+
+  // grid graph searched by this router, nodes are expanded in it before
+  // their edges are visited. May be 0 if the graph is always complete.
+  void setBaseGraph(BaseGraph* gg) { _gg = gg; }
+
+  // Search the cheapest path from any node in from to any node in to. Paths
+  // with costs >= cost.inf() are pruned. Like util::graph::Dijkstra, the
+  // result edges and nodes are written starting at the target. Returns the
+  // path cost, or cost.inf() if no path was found.
+  template <typename C, typename H>
+  float shortestPath(const std::set<GridNode*>& from,
+                     const std::set<GridNode*>& to, const C& cost,
+                     const H& heur,
+                     util::graph::EList<GridNodePL, GridEdgePL>* resEdgs,
+                     util::graph::NList<GridNodePL, GridEdgePL>* resNds) {
+    _numQueries++;
+    if (from.empty() || to.empty()) return cost.inf();
+
+    init(false);
+
+    for (auto n : to) state(FWD, n).tgt = _gen;
+    for (auto n : from) seed(FWD, n, heur, to);
+
+    GridNode* found = 0;
+
+    while (!_heap[FWD].empty()) {
+      HeapEntry cur = pop(FWD);
+
+      if (cost.inf() <= cur.f) break;
+
+      auto& s = _state[FWD][cur.n->pl().getId()];
+      if (s.settled || cur.d > s.d) continue;
+      s.settled = true;
+
+      if (s.tgt == _gen) {
+        found = cur.n;
+        break;
+      }
+
+      if (_gg) _gg->expand(cur.n);
+
+      for (auto e : cur.n->getAdjListOut()) {
+        auto toNd = e->getOtherNd(cur.n);
+        relax(FWD, cur, e, toNd, cost(cur.n, e, toNd), cost.inf(), heur, to);
+      }
+    }
+
+    if (!found) return cost.inf();
+
+    buildPath(found, 0, resEdgs, resNds);
+    return _state[FWD][found->pl().getId()].d;
+  }
+
+  // Same as shortestPath(), but searches from both sides. revHeur has to
+  // estimate the cost of reaching a node from any node in from. Both
+  // searches are A* searches with their own heuristic, the search stops once
+  // the smallest key in one of the queues is not smaller than the best path
+  // found so far, which is exact for admissible heuristics.
+  template <typename C, typename H, typename RH>
+  float biShortestPath(const std::set<GridNode*>& from,
+                       const std::set<GridNode*>& to, const C& cost,
+                       const H& heur, const RH& revHeur,
+                       util::graph::EList<GridNodePL, GridEdgePL>* resEdgs,
+                       util::graph::NList<GridNodePL, GridEdgePL>* resNds) {
+    _numQueries++;
+    if (from.empty() || to.empty()) return cost.inf();
+
+    init(true);
+    _best = cost.inf();
+
+    for (auto n : from) seed(FWD, n, heur, to);
+    for (auto n : to) seed(BWD, n, revHeur, from);
+
+    for (auto n : from) {
+      if (to.count(n)) {
+        _best = 0;
+        _meet = n;
+      }
+    }
+
+    while (true) {
+      float topF = topKey(FWD);
+      float topB = topKey(BWD);
+
+      if (topF >= _best || topB >= _best) break;
+
+      size_t dir = topF <= topB ? FWD : BWD;
+      HeapEntry cur = pop(dir);
+
+      auto& s = _state[dir][cur.n->pl().getId()];
+      if (s.settled || cur.d > s.d) continue;
+      s.settled = true;
+
+      if (_gg) _gg->expand(cur.n);
+
+      if (dir == FWD) {
+        for (auto e : cur.n->getAdjListOut()) {
+          auto toNd = e->getOtherNd(cur.n);
+          relax(FWD, cur, e, toNd, cost(cur.n, e, toNd), _best, heur, to);
+        }
+      } else {
+        for (auto e : cur.n->getAdjListIn()) {
+          auto frNd = e->getOtherNd(cur.n);
+          relax(BWD, cur, e, frNd, cost(frNd, e, cur.n), _best, revHeur,
+                from);
+        }
+      }
+    }
+
+    if (!_meet) return cost.inf();
+
+    buildPath(_meet, _meet, resEdgs, resNds);
+    return _best;
+  }
+
+  // number of searches run by this router so far
+  size_t numQueries() const { return _numQueries; }
+
+ private:
+  static const size_t FWD = 0;
+  static const size_t BWD = 1;
+
+  struct NdState {
+    uint32_t gen = 0;
+    uint32_t tgt = 0;
+    bool settled = false;
+    float d = 0;
+    float h = 0;
+    // edge leading to this node (forward), or away from it (backward)
+    GridEdge* pred = 0;
+  };
+
+  struct HeapEntry {
+    float f;
+    float d;
+    GridNode* n;
+  };
+
+  struct HeapCmp {
+    // min heap on f, prefer deeper entries on ties
+    bool operator()(const HeapEntry& a, const HeapEntry& b) const {
+      return a.f > b.f || (a.f == b.f && a.d < b.d);
+    }
+  };
+
+  BaseGraph* _gg;
+  uint32_t _gen;
+  size_t _numQueries;
+  std::vector<NdState> _state[2];
+  std::vector<HeapEntry> _heap[2];
+
+  // best path found so far by the bidirectional search, and the node where
+  // both searches met
+  bool _bidir;
+  float _best;
+  GridNode* _meet;
+
+  void init(bool bidir) {
+    _heap[FWD].clear();
+    _heap[BWD].clear();
+    _bidir = bidir;
+    _best = std::numeric_limits<float>::infinity();
+    _meet = 0;
+
+    _gen++;
+    if (_gen != 0) return;
+
+    // generation counter overflowed, reset everything once
+    for (auto& st : _state) {
+      for (auto& s : st) s = NdState();
+    }
+    _gen = 1;
+  }
+
+  NdState& state(size_t dir, const GridNode* n) {
+    size_t id = n->pl().getId();
+    if (id >= _state[dir].size()) _state[dir].resize(id + 1);
+    return _state[dir][id];
+  }
+
+  // state of n, initialized for the current query (the heuristic is only
+  // evaluated once per node and query)
+  template <typename H>
+  NdState& touch(size_t dir, const GridNode* n, const H& heur,
+                 const std::set<GridNode*>& to) {
+    auto& s = state(dir, n);
+    if (s.gen == _gen) return s;
+    s.gen = _gen;
+    s.settled = false;
+    s.d = std::numeric_limits<float>::infinity();
+    s.h = heur(n, to);
+    s.pred = 0;
+    return s;
+  }
+
+  // distance of n in direction dir, infinite if n was not reached
+  float dist(size_t dir, const GridNode* n) const {
+    size_t id = n->pl().getId();
+    if (id >= _state[dir].size() || _state[dir][id].gen != _gen) {
+      return std::numeric_limits<float>::infinity();
+    }
+    return _state[dir][id].d;
+  }
+
+  template <typename H>
+  void seed(size_t dir, GridNode* n, const H& heur,
+            const std::set<GridNode*>& to) {
+    auto& s = touch(dir, n, heur, to);
+    if (s.d == 0) return;
+    s.d = 0;
+    push(dir, 0, 0, n);
+  }
+
+  template <typename H>
+  void relax(size_t dir, const HeapEntry& cur, GridEdge* e, GridNode* n,
+             float c, float inf, const H& heur,
+             const std::set<GridNode*>& to) {
+    float d = cur.d + c;
+    if (inf <= d) return;
+
+    auto& s = touch(dir, n, heur, to);
+    if (d >= s.d) return;
+    if (inf <= d + s.h) return;
+
+    // re-open n if it was already settled
+    s.settled = false;
+    s.d = d;
+    s.pred = e;
+    push(dir, d + s.h, d, n);
+
+    if (!_bidir) return;
+
+    // we found a path via n
+    float other = dist(1 - dir, n);
+    if (d + other < _best) {
+      _best = d + other;
+      _meet = n;
+    }
+  }
+
+  float topKey(size_t dir) const {
+    if (_heap[dir].empty()) return std::numeric_limits<float>::infinity();
+    return _heap[dir].front().f;
+  }
+
+  void push(size_t dir, float f, float d, GridNode* n) {
+    _heap[dir].push_back({f, d, n});
+    std::push_heap(_heap[dir].begin(), _heap[dir].end(), HeapCmp());
+  }
+
+  HeapEntry pop(size_t dir) {
+    std::pop_heap(_heap[dir].begin(), _heap[dir].end(), HeapCmp());
+    HeapEntry ret = _heap[dir].back();
+    _heap[dir].pop_back();
+    return ret;
+  }
+
+  // write the path through meet into the result lists, starting at the
+  // target. If meet is 0, only the forward search tree is used, starting at
+  // fwdEnd.
+  void buildPath(GridNode* fwdEnd, GridNode* meet,
+                 util::graph::EList<GridNodePL, GridEdgePL>* resEdgs,
+                 util::graph::NList<GridNodePL, GridEdgePL>* resNds) {
+    if (meet) {
+      // the backward part, from the meeting node to the target
+      util::graph::EList<GridNodePL, GridEdgePL> bwdEdgs;
+      util::graph::NList<GridNodePL, GridEdgePL> bwdNds;
+      for (GridNode* n = meet;;) {
+        auto pred = _state[BWD][n->pl().getId()].pred;
+        if (!pred) break;
+        bwdEdgs.push_back(pred);
+        n = pred->getOtherNd(n);
+        bwdNds.push_back(n);
+      }
+
+      if (resNds) resNds->insert(resNds->end(), bwdNds.rbegin(), bwdNds.rend());
+      if (resEdgs) {
+        resEdgs->insert(resEdgs->end(), bwdEdgs.rbegin(), bwdEdgs.rend());
+      }
+    }
+
+    for (GridNode* n = fwdEnd;;) {
+      if (resNds) resNds->push_back(n);
+      auto pred = _state[FWD][n->pl().getId()].pred;
+      if (!pred) break;
+      if (resEdgs) resEdgs->push_back(pred);
+      n = pred->getOtherNd(n);
+    }
+  }
+};
+
+}  // namespace basegraph
+}  // namespace octi
+
+#endif  // OCTI_BASEGRAPH_GRIDROUTER_H_
@@ -110,6 +110,13 @@ HexGridGraph::getHeur(const std::set<GridNode*>& to) const {
   return new HexGridGraphHeur(this, to);
 }
 
+// _____________________________________________________________________________
+const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
+HexGridGraph::getRevHeur(const std::set<GridNode*>& from) const {
+  // the hex grid heuristic is 0 and thus also admissible backwards
+  return new HexGridGraphHeur(this, from);
+}
+
 // _____________________________________________________________________________
 GridEdge* HexGridGraph::getNEdg(const GridNode* a,
                                     const GridNode* b) const {
@@ -28,9 +28,16 @@ class HexGridGraph : public GridGraph {
   }
 
   virtual void init();
+  // nodes are indexed by position, not by cell, never moved
+  virtual bool reWindow(const util::geo::DBox& bbox) {
+    UNUSED(bbox);
+    return false;
+  }
   virtual GridEdge* getNEdg(const GridNode* a, const GridNode* b) const;
   virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
   getHeur(const std::set<GridNode*>& to) const;
+  virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
+  getRevHeur(const std::set<GridNode*>& from) const;
   virtual size_t maxDeg() const;
   virtual std::vector<double> getCosts() const;
 
@@ -3,6 +3,7 @@
 // Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <unordered_map>
 #include <unordered_set>
@@ -231,27 +232,36 @@ GridEdge* OctiGridGraph::getNEdg(const GridNode* a, const GridNode* b) const {
 }
 
 // _____________________________________________________________________________
-GridNode* OctiGridGraph::writeNd(size_t x, size_t y) {
-  double xPos = _bbox.getLowerLeft().getX() + x * _cellSize;
-  double yPos = _bbox.getLowerLeft().getY() + y * _cellSize;
+DPoint OctiGridGraph::portGeom(size_t x, size_t y, size_t i) const {
+  int p = i;
+  int xi = (4 - (p % 8)) % 4;
+  xi /= abs(abs(xi) - 1) + 1;
+  int yi = (4 - ((p + 2) % 8)) % 4;
+  yi /= abs(abs(yi) - 1) + 1;
+
+  DPoint c = ndGeom(x, y);
+  return DPoint(c.getX() + xi * _spacer, c.getY() + yi * _spacer);
+}
+
+// _____________________________________________________________________________
+void OctiGridGraph::indexNd(size_t x, size_t y, GridNode* n) {
+  // grid nodes are looked up arithmetically, see getNode()
+  UNUSED(x);
+  UNUSED(y);
+  UNUSED(n);
+}
 
-  GridNode* n = addNd(DPoint(xPos, yPos));
-  n->pl().setId(_nds.size());
-  _nds.push_back(n);
+// _____________________________________________________________________________
+GridNode* OctiGridGraph::writeNd(size_t x, size_t y) {
+  GridNode* n = addNd(ndGeom(x, y));
+  regNd(n);
   n->pl().setSink();
-  _grid.add(x, y, n);
   n->pl().setXY(x, y);
   n->pl().setParent(n);
 
   for (int i = 0; i < 8; i++) {
-    int xi = (4 - (i % 8)) % 4;
-    xi /= abs(abs(xi) - 1) + 1;
-    int yi = (4 - ((i + 2) % 8)) % 4;
-    yi /= abs(abs(yi) - 1) + 1;
-
-    GridNode* nn = addNd(DPoint(xPos + xi * _spacer, yPos + yi * _spacer));
-    nn->pl().setId(_nds.size());
-    _nds.push_back(nn);
+    GridNode* nn = addNd(portGeom(x, y, i));
+    regNd(nn);
     nn->pl().setParent(n);
     n->pl().setPort(i, nn);
 
@@ -299,6 +309,40 @@ GridNode* OctiGridGraph::getNode(size_t x, size_t y) const {
   return _nds[_grid.getYHeight() * 9 * x + y * 9];
 }
 
+// _____________________________________________________________________________
+void OctiGridGraph::getGrNdsInBox(const DBox& box,
+                                  std::vector<GridNode*>* ret) const {
+  int64_t xFrom, yFrom, xTo, yTo;
+  getCellsInBox(box, &xFrom, &yFrom, &xTo, &yTo);
+
+  for (int64_t x = xFrom; x <= xTo; x++) {
+    for (int64_t y = yFrom; y <= yTo; y++) {
+      auto n = getNode(x, y);
+      if (n) ret->push_back(n);
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void OctiGridGraph::getCellsInBox(const DBox& box, int64_t* xFrom,
+                                  int64_t* yFrom, int64_t* xTo,
+                                  int64_t* yTo) const {
+  // grid node (x, y) is placed at the lower left corner of cell (x, y), so
+  // the covered cells can be computed directly without a geometric index
+  double llX = _bbox.getLowerLeft().getX();
+  double llY = _bbox.getLowerLeft().getY();
+
+  *xFrom = std::ceil((box.getLowerLeft().getX() - llX) / _cellSize);
+  *yFrom = std::ceil((box.getLowerLeft().getY() - llY) / _cellSize);
+  *xTo = std::floor((box.getUpperRight().getX() - llX) / _cellSize);
+  *yTo = std::floor((box.getUpperRight().getY() - llY) / _cellSize);
+
+  *xFrom = std::max<int64_t>(*xFrom, 0);
+  *yFrom = std::max<int64_t>(*yFrom, 0);
+  *xTo = std::min<int64_t>(*xTo, static_cast<int64_t>(_grid.getXWidth()) - 1);
+  *yTo = std::min<int64_t>(*yTo, static_cast<int64_t>(_grid.getYHeight()) - 1);
+}
+
 // _____________________________________________________________________________
 double OctiGridGraph::heurCost(int64_t xa, int64_t ya, int64_t xb,
                                int64_t yb) const {
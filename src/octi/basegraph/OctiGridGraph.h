@@ -63,8 +63,17 @@ class OctiGridGraph : public GridGraph {
  protected:
   virtual void writeInitialCosts();
   virtual GridNode* writeNd(size_t x, size_t y);
+  virtual util::geo::DPoint portGeom(size_t x, size_t y, size_t i) const;
+  virtual void indexNd(size_t x, size_t y, GridNode* n);
   virtual GridNode* neigh(size_t cx, size_t cy, size_t i) const;
   virtual GridNode* getNode(size_t x, size_t y) const;
+  virtual void getGrNdsInBox(const util::geo::DBox& box,
+                             std::vector<GridNode*>* ret) const;
+
+  // the range of cells (inclusive, clipped to the grid) whose grid node lies
+  // in box, empty if *xFrom > *xTo or *yFrom > *yTo
+  void getCellsInBox(const util::geo::DBox& box, int64_t* xFrom,
+                     int64_t* yFrom, int64_t* xTo, int64_t* yTo) const;
   virtual double getBendPen(size_t i, size_t j) const;
   virtual size_t ang(size_t i, size_t j) const;
   virtual double heurCost(int64_t xa, int64_t ya, int64_t xb, int64_t yb) const;
@@ -25,11 +25,23 @@ class OctiHananGraph : public OctiGridGraph {
   virtual size_t maxDeg() const;
   virtual double ndMovePen(const CombNode* cbNd, const GridNode* grNd) const;
   virtual void init();
+  // node placement depends on the input graph, never moved
+  virtual bool reWindow(const util::geo::DBox& bbox) {
+    UNUSED(bbox);
+    return false;
+  }
 
  protected:
   virtual GridNode* writeNd(size_t x, size_t y);
   virtual GridNode* neigh(size_t cx, size_t cy, size_t i) const;
   virtual GridNode* getNode(size_t x, size_t y) const;
+
+  // Hanan (and quadtree) nodes do not cover the full grid, use the geometric
+  // index
+  virtual void getGrNdsInBox(const util::geo::DBox& box,
+                             std::vector<GridNode*>* ret) const {
+    GridGraph::getGrNdsInBox(box, ret);
+  }
   virtual double getBendPen(size_t i, size_t j) const;
   virtual size_t ang(size_t i, size_t j) const;
   virtual void connectNodes(GridNode* grNdA, GridNode* grNdB, size_t dir);
@@ -70,6 +70,13 @@ OrthoRadialGraph::getHeur(const std::set<GridNode*>& to) const {
   return new OrthoRadialGraphHeur(this, to);
 }
 
+// _____________________________________________________________________________
+const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
+OrthoRadialGraph::getRevHeur(const std::set<GridNode*>& from) const {
+  // the forward heuristic is 0 and thus also admissible backwards
+  return new OrthoRadialGraphHeur(this, from);
+}
+
 // _____________________________________________________________________________
 GridEdge* OrthoRadialGraph::getNEdg(const GridNode* a,
                                     const GridNode* b) const {
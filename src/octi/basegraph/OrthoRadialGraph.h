@@ -24,9 +24,16 @@ class OrthoRadialGraph : public GridGraph {
   }
 
   virtual void init();
+  // rings are laid out around the bbox center, never moved
+  virtual bool reWindow(const util::geo::DBox& bbox) {
+    UNUSED(bbox);
+    return false;
+  }
   virtual GridEdge* getNEdg(const GridNode* a, const GridNode* b) const;
   virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
   getHeur(const std::set<GridNode*>& to) const;
+  virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
+  getRevHeur(const std::set<GridNode*>& from) const;
 
   virtual PolyLine<double> geomFromPath(
       const std::vector<std::pair<size_t, size_t>>& res) const;
@@ -57,7 +57,7 @@ void PseudoOrthoRadialGraph::writeObstacleCost(
 
 // _____________________________________________________________________________
 void PseudoOrthoRadialGraph::writeGeoCoursePens(const CombEdge* ce,
-                                                GeoPensMap* target,
+                                                GeoPens* target,
                                                 double pen) {
   std::set<GridNode*> neighs;
 
@@ -75,6 +75,20 @@ void PseudoOrthoRadialGraph::writeGeoCoursePens(const CombEdge* ce,
   box = util::geo::pad(box, sqrt(SOFT_INF / pen) * getCellSize());
   _grid.get(box, &neighs);
 
+  *target = GeoPens();
+  if (neighs.empty()) return;
+
+  size_t xMin = std::numeric_limits<size_t>::max(), xMax = 0;
+  size_t yMin = std::numeric_limits<size_t>::max(), yMax = 0;
+  for (auto grNd : neighs) {
+    xMin = std::min(xMin, grNd->pl().getX());
+    xMax = std::max(xMax, grNd->pl().getX());
+    yMin = std::min(yMin, grNd->pl().getY());
+    yMax = std::max(yMax, grNd->pl().getY());
+  }
+
+  target->reset(xMin, yMin, xMax, yMax, maxDeg());
+
   for (auto grNdA : neighs) {
     for (size_t i = 0; i < maxDeg(); i++) {
       auto grNeigh = neigh(grNdA->pl().getX(), grNdA->pl().getY(), i);
@@ -97,7 +111,7 @@ void PseudoOrthoRadialGraph::writeGeoCoursePens(const CombEdge* ce,
 
       d *= pen * d;
 
-      if (d <= SOFT_INF) (*target)[ce][ge->pl().getId()] = d;
+      if (d <= SOFT_INF) target->set(ge, d);
     }
   }
 }
@@ -218,6 +232,12 @@ PseudoOrthoRadialGraph::getHeur(const std::set<GridNode*>& to) const {
   return new PseudoOrthoRadialGraphHeur(this, to);
 }
 
+// _____________________________________________________________________________
+const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
+PseudoOrthoRadialGraph::getRevHeur(const std::set<GridNode*>& from) const {
+  return new PseudoOrthoRadialGraphHeur(this, from, true);
+}
+
 // _____________________________________________________________________________
 GridEdge* PseudoOrthoRadialGraph::getNEdg(const GridNode* a,
                                           const GridNode* b) const {
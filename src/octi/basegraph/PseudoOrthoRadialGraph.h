@@ -24,15 +24,22 @@ class PseudoOrthoRadialGraph : public GridGraph {
   }
 
   virtual void init();
+  // the pseudo-radial layout depends on the bbox center, never moved
+  virtual bool reWindow(const util::geo::DBox& bbox) {
+    UNUSED(bbox);
+    return false;
+  }
   virtual GridEdge* getNEdg(const GridNode* a, const GridNode* b) const;
   virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
   getHeur(const std::set<GridNode*>& to) const;
+  virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
+  getRevHeur(const std::set<GridNode*>& from) const;
   virtual double heurCost(int64_t xa, int64_t ya, int64_t xb, int64_t yb) const;
 
   virtual PolyLine<double> geomFromPath(
       const std::vector<std::pair<size_t, size_t>>& res) const;
   virtual double ndMovePen(const CombNode* cbNd, const GridNode* grNd) const;
-  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPensMap* target,
+  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPens* target,
                                   double pen);
 
  protected:
@@ -52,9 +59,11 @@ class PseudoOrthoRadialGraph : public GridGraph {
 
 struct PseudoOrthoRadialGraphHeur
     : public util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float> {
+  // if rev is set, the heuristic estimates the cost of reaching a node from
+  // any node in to, see GridGraphHeur
   PseudoOrthoRadialGraphHeur(const basegraph::GridGraph* g,
-                             const std::set<GridNode*>& to)
-      : g(g), to(0) {
+                             const std::set<GridNode*>& to, bool rev = false)
+      : g(g), to(0), rev(rev) {
     cheapestSink = std::numeric_limits<float>::infinity();
 
     for (auto n : to) {
@@ -62,7 +71,7 @@ struct PseudoOrthoRadialGraphHeur
       size_t i = 0;
       for (; i < g->maxDeg(); i++) {
         if (!n->pl().getPort(i)) continue;
-        float sinkCost = g->getEdg(n->pl().getPort(i), n)->pl().cost();
+        float sinkCost = sinkEdg(n, i)->pl().cost();
         if (sinkCost < cheapestSink) cheapestSink = sinkCost;
         auto neigh = g->neigh(n, i);
         if (neigh && to.find(neigh) == to.end()) {
@@ -73,7 +82,7 @@ struct PseudoOrthoRadialGraphHeur
       }
       for (size_t j = i; j < g->maxDeg(); j++) {
         if (!n->pl().getPort(j)) continue;
-        float sinkCost = g->getEdg(n->pl().getPort(j), n)->pl().cost();
+        float sinkCost = sinkEdg(n, j)->pl().cost();
         if (sinkCost < cheapestSink) cheapestSink = sinkCost;
       }
     }
@@ -94,8 +103,14 @@ struct PseudoOrthoRadialGraphHeur
     return ret + cheapestSink;
   }
 
+  const GridEdge* sinkEdg(const GridNode* n, size_t port) const {
+    if (rev) return g->getEdg(n, n->pl().getPort(port));
+    return g->getEdg(n->pl().getPort(port), n);
+  }
+
   const octi::basegraph::BaseGraph* g;
   GridNode* to;
+  bool rev;
   std::vector<size_t> hull;
   float cheapestSink;
 };
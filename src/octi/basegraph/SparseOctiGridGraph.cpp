@@ -0,0 +1,326 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+#include "octi/basegraph/SparseOctiGridGraph.h"
+#include "util/Misc.h"
+
+using octi::basegraph::CrossEdgPairs;
+using octi::basegraph::GridEdge;
+using octi::basegraph::GridNode;
+using octi::basegraph::SparseOctiGridGraph;
+using util::geo::contains;
+using util::geo::DBox;
+using util::geo::dist;
+using util::geo::DPoint;
+using util::geo::intersects;
+using util::geo::LineSegment;
+
+// _____________________________________________________________________________
+void SparseOctiGridGraph::init() {
+  // reserve the ids of every cell, nodes are only written on demand
+  _nds.assign(_grid.getXWidth() * _grid.getYHeight() * (maxDeg() + 1), 0);
+}
+
+// _____________________________________________________________________________
+void SparseOctiGridGraph::expand(const GridNode* n) {
+  // only ports have edges leaving their cell
+  auto parent = n->pl().getParent();
+  if (parent == n) return;
+
+  for (size_t i = 0; i < maxDeg(); i++) {
+    if (parent->pl().getPort(i) != n) continue;
+    size_t nx, ny;
+    if (neighCell(parent->pl().getX(), parent->pl().getY(), i, &nx, &ny)) {
+      getNode(nx, ny);
+    }
+    return;
+  }
+}
+
+// _____________________________________________________________________________
+GridNode* SparseOctiGridGraph::getNode(size_t x, size_t y) const {
+  if (x >= _grid.getXWidth() || y >= _grid.getYHeight()) return 0;
+
+  auto n = peekNode(x, y);
+  if (n) return n;
+
+  // conceptually, every grid node is always present
+  return const_cast<SparseOctiGridGraph*>(this)->writeNd(x, y);
+}
+
+// _____________________________________________________________________________
+GridNode* SparseOctiGridGraph::peekNode(size_t x, size_t y) const {
+  if (x >= _grid.getXWidth() || y >= _grid.getYHeight()) return 0;
+  return _nds[(x * _grid.getYHeight() + y) * (maxDeg() + 1)];
+}
+
+// _____________________________________________________________________________
+GridNode* SparseOctiGridGraph::getGrNdById(size_t id) const {
+  if (id >= _nds.size()) return 0;
+
+  size_t cell = id / (maxDeg() + 1);
+  getNode(cell / _grid.getYHeight(), cell % _grid.getYHeight());
+
+  // 0 for pruned ports
+  return _nds[id];
+}
+
+// _____________________________________________________________________________
+const GridEdge* SparseOctiGridGraph::getGrEdgById(
+    std::pair<size_t, size_t> id) const {
+  auto fr = getGrNdById(id.first);
+  auto to = getGrNdById(id.second);
+  assert(fr);
+  assert(to);
+  return getEdg(fr, to);
+}
+
+// _____________________________________________________________________________
+GridNode* SparseOctiGridGraph::writeNd(size_t x, size_t y) {
+  size_t cell = x * _grid.getYHeight() + y;
+
+  // ids only depend on the cell
+  _nextNdId = cell * (maxDeg() + 1);
+  _edgeCount = cell * cellEdgs();
+
+  GridNode* n = OctiGridGraph::writeNd(x, y);
+
+  for (size_t i = 0; i < maxDeg(); i++) {
+    auto port = n->pl().getPort(i);
+    size_t nx, ny;
+
+    if (!neighCell(x, y, i, &nx, &ny)) {
+      // ports on the grid border are never used, see prunePorts()
+      n->pl().setPort(i, 0);
+      _nds[port->pl().getId()] = 0;
+      delNd(port);
+      continue;
+    }
+
+    // grid edges to cells which have not been written yet are added once
+    // these cells are written
+    auto neigh = peekNode(nx, ny);
+    if (!neigh) continue;
+
+    size_t j = (i + maxDeg() / 2) % maxDeg();
+    auto oPort = neigh->pl().getPort(j);
+
+    addGridEdg(port, oPort, x, y, i);
+    addGridEdg(oPort, port, nx, ny, j);
+  }
+
+  return n;
+}
+
+// _____________________________________________________________________________
+void SparseOctiGridGraph::regNd(GridNode* n) {
+  n->pl().setId(_nextNdId);
+  _nds[_nextNdId] = n;
+  _nextNdId++;
+}
+
+// _____________________________________________________________________________
+bool SparseOctiGridGraph::neighCell(size_t x, size_t y, size_t i, size_t* nx,
+                                    size_t* ny) const {
+  // same directions as OctiGridGraph::neigh()
+  int64_t dx = 1;
+  if (i % 4 == 0) dx = 0;
+  if (i > 4) dx = -1;
+
+  int64_t dy = 1;
+  if (i == 2 || i == 6) dy = 0;
+  if (i == 3 || i == 4 || i == 5) dy = -1;
+
+  int64_t cx = static_cast<int64_t>(x) + dx;
+  int64_t cy = static_cast<int64_t>(y) + dy;
+
+  if (cx < 0 || cy < 0) return false;
+  if (cx >= static_cast<int64_t>(_grid.getXWidth())) return false;
+  if (cy >= static_cast<int64_t>(_grid.getYHeight())) return false;
+
+  *nx = cx;
+  *ny = cy;
+  return true;
+}
+
+// _____________________________________________________________________________
+size_t SparseOctiGridGraph::cellEdgs() const {
+  // sink edges in both directions, bend edges between all port pairs in both
+  // directions
+  return 2 * maxDeg() + maxDeg() * (maxDeg() - 1);
+}
+
+// _____________________________________________________________________________
+size_t SparseOctiGridGraph::gridEdgId(size_t x, size_t y, size_t i) const {
+  // grid edges are numbered after the edges inside the cells
+  size_t cells = _grid.getXWidth() * _grid.getYHeight();
+  return cells * cellEdgs() + (x * _grid.getYHeight() + y) * maxDeg() + i;
+}
+
+// _____________________________________________________________________________
+void SparseOctiGridGraph::addGridEdg(GridNode* fr, GridNode* to, size_t x,
+                                     size_t y, size_t i) {
+  auto e = addEdg(fr, to, GridEdgePL(9, false, false));
+  e->pl().setId(gridEdgId(x, y, i));
+
+  writeGridEdgCost(e, i);
+
+  for (const auto& obst : _obstacles) {
+    if (obstructed(e, obst)) {
+      e->pl().setCost(std::numeric_limits<double>::infinity());
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void SparseOctiGridGraph::writeGridEdgCost(GridEdge* e, size_t i) const {
+  if (i % 4 == 0) {
+    e->pl().setCost(_c.verticalPen);
+  } else if ((i + 2) % 4 == 0) {
+    e->pl().setCost(_c.horizontalPen);
+  } else {
+    e->pl().setCost(_c.diagonalPen);
+  }
+}
+
+// _____________________________________________________________________________
+bool SparseOctiGridGraph::obstructed(
+    const GridEdge* e, const util::geo::Polygon<double>& obst) const {
+  LineSegment<double> ls(*e->getFrom()->pl().getGeom(),
+                         *e->getTo()->pl().getGeom());
+  return intersects(ls, obst) || contains(ls, obst);
+}
+
+// _____________________________________________________________________________
+void SparseOctiGridGraph::writeInitialCosts() {
+  // only touch the grid nodes which have already been written
+  for (auto n : getNds()) {
+    if (!n->pl().isSink()) continue;
+
+    for (size_t i = 0; i < maxDeg(); i++) {
+      auto port = n->pl().getPort(i);
+      size_t nx, ny;
+      if (!port || !neighCell(n->pl().getX(), n->pl().getY(), i, &nx, &ny)) {
+        continue;
+      }
+
+      auto neigh = peekNode(nx, ny);
+      if (!neigh) continue;
+
+      auto oPort = neigh->pl().getPort((i + maxDeg() / 2) % maxDeg());
+      writeGridEdgCost(getEdg(port, oPort), i);
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void SparseOctiGridGraph::writeObstacleCost(
+    const util::geo::Polygon<double>& obst) {
+  // grid nodes written later check the obstacles themselves
+  for (auto n : getNds()) {
+    if (!n->pl().isSink()) continue;
+
+    for (size_t i = 0; i < maxDeg(); i++) {
+      size_t nx, ny;
+      if (!neighCell(n->pl().getX(), n->pl().getY(), i, &nx, &ny)) continue;
+
+      auto ge = getNEdg(n, peekNode(nx, ny));
+      if (!ge) continue;
+
+      if (obstructed(ge, obst)) {
+        ge->pl().setCost(std::numeric_limits<double>::infinity());
+      }
+    }
+  }
+}
+
+// _____________________________________________________________________________
+CrossEdgPairs SparseOctiGridGraph::getCrossEdgPairs() const {
+  CrossEdgPairs ret;
+
+  // same as OctiGridGraph::getCrossEdgPairs(), but never writes grid nodes
+  for (const GridNode* n : getNds()) {
+    if (!n->pl().isSink()) continue;
+
+    size_t x = n->pl().getX();
+    size_t y = n->pl().getY();
+    size_t nx, ny;
+
+    if (!neighCell(x, y, 3, &nx, &ny)) continue;
+    auto m = peekNode(nx, ny);
+
+    auto eOr = getNEdg(n, m);
+    auto fOr = getNEdg(m, n);
+
+    if (!eOr || !fOr) continue;
+
+    // both cells exist, as the diagonal does
+    auto na = peekNode(x + 1, y);
+    auto nb = peekNode(x, y - 1);
+
+    if (!na || !nb) continue;
+
+    auto e = getNEdg(na, nb);
+    auto f = getNEdg(nb, na);
+    ret.push_back({{eOr, fOr}, {e, f}});
+  }
+
+  return ret;
+}
+
+// _____________________________________________________________________________
+void SparseOctiGridGraph::writeGeoCoursePens(const CombEdge* ce,
+                                             GeoPens* target, double pen) {
+  DBox box;
+
+  std::vector<util::geo::DLine> geoms;
+
+  for (auto orE : ce->pl().getChilds()) {
+    box = util::geo::extendBox(*orE->pl().getGeom(), box);
+
+    // operate on simplified geometries
+    geoms.push_back(util::geo::simplify(*orE->pl().getGeom(), 5));
+  }
+
+  box = util::geo::pad(box, sqrt(SOFT_INF / pen) * getCellSize());
+
+  // the penalties only depend on the port positions, so they are computed
+  // from the cells without writing any grid node. This is also required as
+  // this may be called concurrently.
+  int64_t xFrom, yFrom, xTo, yTo;
+  getCellsInBox(box, &xFrom, &yFrom, &xTo, &yTo);
+
+  *target = GeoPens();
+  if (xFrom > xTo || yFrom > yTo) return;
+
+  target->reset(xFrom, yFrom, xTo, yTo, maxDeg());
+
+  for (int64_t x = xFrom; x <= xTo; x++) {
+    for (int64_t y = yFrom; y <= yTo; y++) {
+      for (size_t i = 0; i < maxDeg(); i++) {
+        size_t nx, ny;
+        if (!neighCell(x, y, i, &nx, &ny)) continue;
+
+        auto fr = portGeom(x, y, i);
+        auto to = portGeom(nx, ny, (i + maxDeg() / 2) % maxDeg());
+
+        float d = std::numeric_limits<float>::infinity();
+
+        for (const auto& geom : geoms) {
+          double dLoc = fmax(dist(geom, fr), dist(geom, to)) / getCellSize();
+          if (dLoc < d) d = dLoc;
+        }
+
+        d *= pen * d;
+
+        if (d <= SOFT_INF) target->set(x, y, i, d);
+      }
+    }
+  }
+}
@@ -0,0 +1,69 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef OCTI_BASEGRAPH_SPARSEOCTIGRIDGRAPH_H_
+#define OCTI_BASEGRAPH_SPARSEOCTIGRIDGRAPH_H_
+
+#include "octi/basegraph/OctiGridGraph.h"
+
+namespace octi {
+namespace basegraph {
+
+// Octilinear grid graph whose grid nodes (with their ports, sink and bend
+// edges) are only written once they are first accessed, either directly or
+// by the router expanding into their cell. Memory is thus bounded by the
+// explored area instead of the bounding box.
+//
+// Node and edge ids only depend on the cell position, so they match between
+// sparse grid graphs of the same bounding box, no matter which cells have
+// been written.
+class SparseOctiGridGraph : public OctiGridGraph {
+ public:
+  using GridGraph::neigh;
+  SparseOctiGridGraph(const util::geo::DBox& bbox, double cellSize,
+                      double spacer, const Penalties& pens)
+      : OctiGridGraph(bbox, cellSize, spacer, pens), _nextNdId(0) {}
+
+  virtual void init();
+  virtual void expand(const GridNode* n);
+
+  virtual GridNode* getGrNdById(size_t id) const;
+  virtual const GridEdge* getGrEdgById(std::pair<size_t, size_t> id) const;
+
+  virtual CrossEdgPairs getCrossEdgPairs() const;
+
+  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPens* target,
+                                  double pen);
+
+ protected:
+  virtual void writeInitialCosts();
+  virtual void writeObstacleCost(const util::geo::Polygon<double>& obst);
+
+  virtual GridNode* writeNd(size_t x, size_t y);
+  virtual void regNd(GridNode* n);
+
+  // returns the grid node of cell (x, y), writing it if necessary
+  virtual GridNode* getNode(size_t x, size_t y) const;
+
+ private:
+  size_t _nextNdId;
+
+  // grid node of cell (x, y) if it has already been written, else 0
+  GridNode* peekNode(size_t x, size_t y) const;
+
+  // cell of the neighbor of cell (x, y) in direction i, false if outside
+  bool neighCell(size_t x, size_t y, size_t i, size_t* nx, size_t* ny) const;
+
+  size_t cellEdgs() const;
+  size_t gridEdgId(size_t x, size_t y, size_t i) const;
+
+  void addGridEdg(GridNode* fr, GridNode* to, size_t x, size_t y, size_t i);
+  void writeGridEdgCost(GridEdge* e, size_t i) const;
+  bool obstructed(const GridEdge* e,
+                  const util::geo::Polygon<double>& obst) const;
+};
+}  // namespace basegraph
+}  // namespace octi
+
+#endif  // OCTI_BASEGRAPH_SPARSEOCTIGRIDGRAPH_H_
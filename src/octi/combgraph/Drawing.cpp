@@ -24,6 +24,28 @@ using shared::linegraph::LineNode;
 using util::geo::BezierCurve;
 using util::graph::Dijkstra;
 
+namespace {
+
+// _____________________________________________________________________________
+template <typename K, typename V>
+void snap(const std::map<K, V>& m, K k, bool* has, V* v) {
+  auto it = m.find(k);
+  *has = it != m.end();
+  if (*has) *v = it->second;
+}
+
+// _____________________________________________________________________________
+template <typename K, typename V>
+void restore(std::map<K, V>* m, K k, bool has, const V& v) {
+  if (has) {
+    (*m)[k] = v;
+  } else {
+    m->erase(k);
+  }
+}
+
+}  // namespace
+
 // _____________________________________________________________________________
 double Drawing::score() const {
   return _c + violations() * basegraph::SOFT_INF;
@@ -56,6 +78,10 @@ Score Drawing::fullScore() const {
 
 // _____________________________________________________________________________
 void Drawing::draw(CombEdge* ce, const GrEdgList& ges, bool rev) {
+  logEdg(ce);
+  logNd(ce->getFrom());
+  logNd(ce->getTo());
+
   if (_c == std::numeric_limits<double>::infinity()) _c = 0;
   if (_edgs.count(ce)) _edgs[ce].clear();
 
@@ -468,6 +494,10 @@ void Drawing::getLineGraph(LineGraph* target) const {
 }
 // _____________________________________________________________________________
 void Drawing::crumble() {
+  _log.checkpoints.clear();
+  _log.nds.clear();
+  _log.edgs.clear();
+
   _c = std::numeric_limits<double>::infinity();
   _violations = 0;
   _nds.clear();
@@ -550,6 +580,10 @@ const std::map<const CombEdge*, GrPath>& Drawing::getEdgPaths() const {
 
 // _____________________________________________________________________________
 void Drawing::erase(CombEdge* ce) {
+  logEdg(ce);
+  logNd(ce->getFrom());
+  logNd(ce->getTo());
+
   _edgs.erase(ce);
   _c -= _edgCosts[ce];
   _edgCosts.erase(ce);
@@ -573,6 +607,8 @@ void Drawing::erase(CombEdge* ce) {
 
 // _____________________________________________________________________________
 void Drawing::erase(CombNode* cn) {
+  logNd(cn);
+
   _nds.erase(cn);
   _c -= _ndReachCosts[cn];
   _c -= _ndBndCosts[cn];
@@ -646,3 +682,74 @@ double Drawing::getNdReachCost(const CombNode* n) const {
   if (_ndReachCosts.count(n)) return _ndReachCosts.find(n)->second;
   return 0;
 }
+
+// _____________________________________________________________________________
+void Drawing::checkpoint() {
+  _log.checkpoints.push_back(
+      {_c, _violations, _log.nds.size(), _log.edgs.size()});
+}
+
+// _____________________________________________________________________________
+void Drawing::rollback() {
+  assert(_log.checkpoints.size());
+  const auto cp = _log.checkpoints.back();
+  _log.checkpoints.pop_back();
+
+  // restore in reverse order, the oldest entry of a node or edge wins
+  while (_log.edgs.size() > cp.edgLogSize) {
+    const auto& u = _log.edgs.back();
+    restore(&_edgs, u.edg, u.hasPath, u.path);
+    restore(&_edgCosts, u.edg, u.hasCost, u.cost);
+    restore(&_vios, u.edg, u.hasVios, u.vios);
+    restore(&_springCosts, u.edg, u.hasSpring, u.spring);
+    _log.edgs.pop_back();
+  }
+
+  while (_log.nds.size() > cp.ndLogSize) {
+    const auto& u = _log.nds.back();
+    restore(&_nds, u.nd, u.hasPos, u.pos);
+    restore(&_ndReachCosts, u.nd, u.hasReach, u.reach);
+    restore(&_ndBndCosts, u.nd, u.hasBnd, u.bnd);
+    _log.nds.pop_back();
+  }
+
+  _c = cp.c;
+  _violations = cp.violations;
+}
+
+// _____________________________________________________________________________
+void Drawing::commit() {
+  assert(_log.checkpoints.size());
+  _log.checkpoints.pop_back();
+
+  // the changes may still be needed by an outer checkpoint
+  if (_log.checkpoints.empty()) {
+    _log.nds.clear();
+    _log.edgs.clear();
+  }
+}
+
+// _____________________________________________________________________________
+void Drawing::logNd(const CombNode* nd) {
+  if (_log.checkpoints.empty()) return;
+
+  NdUndo u;
+  u.nd = nd;
+  snap(_nds, nd, &u.hasPos, &u.pos);
+  snap(_ndReachCosts, nd, &u.hasReach, &u.reach);
+  snap(_ndBndCosts, nd, &u.hasBnd, &u.bnd);
+  _log.nds.push_back(u);
+}
+
+// _____________________________________________________________________________
+void Drawing::logEdg(const CombEdge* e) {
+  if (_log.checkpoints.empty()) return;
+
+  EdgUndo u;
+  u.edg = e;
+  snap(_edgs, e, &u.hasPath, &u.path);
+  snap(_edgCosts, e, &u.hasCost, &u.cost);
+  snap(_vios, e, &u.hasVios, &u.vios);
+  snap(_springCosts, e, &u.hasSpring, &u.spring);
+  _log.edgs.push_back(u);
+}
@@ -88,6 +88,17 @@ class Drawing {
   void erase(CombEdge* ce);
   void erase(CombNode* ce);
 
+  // start recording changes made by draw() and erase(), checkpoints may be
+  // nested
+  void checkpoint();
+
+  // undo all changes since the last checkpoint and drop it, only the
+  // touched nodes and edges are restored
+  void rollback();
+
+  // keep all changes since the last checkpoint and drop it
+  void commit();
+
   void getLineGraph(LineGraph* target) const;
 
   const GridNode* getGrNd(const CombNode* cn);
@@ -124,7 +135,45 @@ class Drawing {
 
   size_t _violations;
 
+  // previous state of a node or edge, recorded before it is changed
+  struct NdUndo {
+    const CombNode* nd;
+    bool hasPos, hasReach, hasBnd;
+    size_t pos;
+    double reach, bnd;
+  };
+
+  struct EdgUndo {
+    const CombEdge* edg;
+    bool hasPath, hasCost, hasVios, hasSpring;
+    GrPath path;
+    double cost, spring;
+    int vios;
+  };
+
+  struct Checkpoint {
+    double c;
+    size_t violations;
+    size_t ndLogSize, edgLogSize;
+  };
+
+  // the undo log is local to a drawing and never copied
+  struct UndoLog {
+    UndoLog() {}
+    UndoLog(const UndoLog&) {}
+    UndoLog& operator=(const UndoLog&) { return *this; }
+
+    std::vector<Checkpoint> checkpoints;
+    std::vector<NdUndo> nds;
+    std::vector<EdgUndo> edgs;
+  };
+
+  UndoLog _log;
+
   double recalcBends(const CombNode* nd);
+
+  void logNd(const CombNode* nd);
+  void logEdg(const CombEdge* e);
 };
 }  // namespace combgraph
 }  // namespace octi
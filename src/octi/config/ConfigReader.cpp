@@ -54,16 +54,34 @@ void ConfigReader::help(const char* bin) const {
             << std::setw(39) << "  -b [ -base-graph ] arg (=octilinear)"
             << "base graph, either ortholinear, octilinear,\n"
             << std::setw(39) << " "
-            << " orthoradial, quadtree, octihanan\n\n"
+            << " orthoradial, quadtree, octihanan,\n"
+            << std::setw(39) << " "
+            << " sparseoctilinear (octilinear, nodes are\n"
+            << std::setw(39) << " "
+            << " only created where the routing needs them)\n\n"
             << "Misc:\n"
             << std::setw(39) << "  --retry-on-error"
             << "retry 85\% of grid size on error, 30 times\n"
+            << std::setw(39) << "  --retry-parallel arg (=1)"
+            << "number of grid sizes tried in parallel\n"
+            << std::setw(39) << " "
+            << " with --retry-on-error\n"
             << std::setw(39) << "  --skip-on-error"
             << "skip graph on error\n"
             << std::setw(39) << "  --ilp-num-threads arg (=0)"
             << "number of threads to use by ILP solver,\n"
             << std::setw(39) << " "
             << " 0 means solver default\n"
+            << std::setw(39) << "  --heur-num-threads arg (=0)"
+            << "number of parallel workers used by heur,\n"
+            << std::setw(39) << " "
+            << " 0 means number of available cores, at\n"
+            << std::setw(39) << " "
+            << " most 4\n"
+            << std::setw(39) << "  --comp-num-threads arg (=1)"
+            << "number of components drawn in parallel,\n"
+            << std::setw(39) << " "
+            << " 0 means number of available cores\n"
             << std::setw(39) << "  --hanan-iters arg (=1)"
             << "number of Hanan grid iterations\n"
             << std::setw(39) << "  --loc-search-max-iters arg (=100)"
@@ -74,12 +92,30 @@ void ConfigReader::help(const char* bin) const {
             << "ILP solve time limit (seconds), -1 for infinite\n"
             << std::setw(39) << "  --ilp-cache-dir arg (=.)"
             << "ILP cache dir\n"
+            << std::setw(39) << "  --ilp-corridor arg (=0)"
+            << "restrict ILP to this many grid cells around\n"
+            << std::setw(39) << " "
+            << " heuristic solution, 0 for no restriction\n"
+            << std::setw(39) << "  --ilp-corridor-iters arg (=1)"
+            << "max number of ILP solves, each in a corridor\n"
+            << std::setw(39) << " "
+            << " around the previous solution\n"
+            << std::setw(39) << "  --ilp-prune-slack arg (=-1)"
+            << "prune ILP to ellipses around edge endpoints\n"
+            << std::setw(39) << " "
+            << " allowing detours of this many grid cells,\n"
+            << std::setw(39) << " "
+            << " -1 to disable\n"
             << std::setw(39) << "  --ilp-solver arg (=gurobi)"
             << "Preferred ILP solver, either glpk, cbc, or gurobi,\n"
             << std::setw(39) << " "
             << " will fall back if not available.\n"
             << std::setw(39) << "  --write-stats"
             << "write stats to output graph\n"
+            << std::setw(39) << "  --precision arg (=-1)"
+            << "decimal places of output coordinates, -1 for\n"
+            << std::setw(39) << " "
+            << " default formatting\n"
             << std::setw(39) << "  -D [ --from-dot ]"
             << "input is in dot format\n"
             << std::setw(39) << "  --no-deg2-heur"
@@ -153,6 +189,13 @@ void ConfigReader::read(Config* cfg, int argc, char** argv) const {
                          {"nd-move-pen", required_argument, 0, 24},
                          {"skip-on-error", no_argument, 0, 25},
                          {"retry-on-error", no_argument, 0, 26},
+                         {"precision", required_argument, 0, 27},
+                         {"heur-num-threads", required_argument, 0, 28},
+                         {"comp-num-threads", required_argument, 0, 29},
+                         {"retry-parallel", required_argument, 0, 30},
+                         {"ilp-corridor", required_argument, 0, 31},
+                         {"ilp-corridor-iters", required_argument, 0, 32},
+                         {"ilp-prune-slack", required_argument, 0, 33},
                          {"abort-after", required_argument, 0, 'a'},
                          {0, 0, 0, 0}};
 
@@ -247,6 +290,27 @@ void ConfigReader::read(Config* cfg, int argc, char** argv) const {
       case 26:
         cfg->retryOnError = true;
         break;
+      case 27:
+        cfg->outputPrecision = atoi(optarg);
+        break;
+      case 28:
+        cfg->heurNumThreads = atoi(optarg);
+        break;
+      case 29:
+        cfg->compNumThreads = atoi(optarg);
+        break;
+      case 30:
+        cfg->retryNumParallel = atoi(optarg);
+        break;
+      case 31:
+        cfg->ilpCorridor = atof(optarg);
+        break;
+      case 32:
+        cfg->ilpCorridorIters = atoi(optarg);
+        break;
+      case 33:
+        cfg->ilpPruneSlack = atof(optarg);
+        break;
       case 'g':
         cfg->gridSize = optarg;
         break;
@@ -301,6 +365,8 @@ void ConfigReader::read(Config* cfg, int argc, char** argv) const {
     cfg->baseGraphType = BaseGraphType::HEXGRID;
   } else if (baseGraphStr == "chulloctilinear") {
     cfg->baseGraphType = BaseGraphType::CONVEXHULLOCTIGRID;
+  } else if (baseGraphStr == "sparseoctilinear") {
+    cfg->baseGraphType = BaseGraphType::SPARSEOCTIGRID;
   } else if (baseGraphStr == "porthoradial") {
     cfg->baseGraphType = BaseGraphType::PSEUDOORTHORADIAL;
   } else if (baseGraphStr == "orthoradial") {
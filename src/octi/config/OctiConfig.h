@@ -41,18 +41,42 @@ struct Config {
   std::string ilpSolver = "gurobi";
   std::string ilpCacheDir = ".";
 
+  // restrict the ILP edge variables to this many grid cells around the
+  // heuristic solution, 0 means no restriction
+  double ilpCorridor = 0;
+
+  // max number of ILP solves, each in a corridor around the previous solution
+  size_t ilpCorridorIters = 1;
+
+  // prune ILP edge variables outside an ellipse around the comb edge
+  // endpoints that allows detours of this many grid cells, -1 disables
+  double ilpPruneSlack = -1;
+
   bool skipOnError = false;
   bool retryOnError = false;
 
+  // number of grid sizes tried in parallel when retrying on error
+  size_t retryNumParallel = 1;
+
   double maxGrDist = 3;
 
   int heurLocSearchIters = 100;
 
+  // number of parallel workers for the heuristic drawing, 0 means the number
+  // of available cores, but at most 4
+  size_t heurNumThreads = 0;
+
+  // number of connected components drawn in parallel, 0 means the number of
+  // available cores
+  size_t compNumThreads = 1;
+
   size_t abortAfter = -1;
 
   size_t hananIters = 1;
   bool writeStats = false;
 
+  int outputPrecision = -1;
+
   OrderMethod orderMethod;
 
   std::string obstaclePath;
@@ -2,6 +2,7 @@
 // Chair of Algorithms and Data Structures.
 // Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
+#include <algorithm>
 #include <fstream>
 
 #include "octi/basegraph/BaseGraph.h"
@@ -24,51 +25,88 @@ using shared::optim::StarterSol;
 ILPStats ILPGridOptimizer::optimize(BaseGraph* gg, const CombGraph& cg,
                                     combgraph::Drawing* d, double maxGrDist,
                                     bool noSolve, const GeoPensMap* geoPensMap,
-                                    int timeLim, const std::string& cacheDir,
+                                    double corridorRad, size_t corridorIters,
+                                    double pruneSlack, int timeLim,
+                                    const std::string& cacheDir,
                                     double cacheThreshold, int numThreads,
                                     const std::string& solverStr,
                                     const std::string& path) const {
-  // extract first feasible solution from gridgraph
   ILPStats s{std::numeric_limits<double>::infinity(), 0, 0, 0, 0};
-  StarterSol sol = extractFeasibleSol(d, gg, cg, maxGrDist);
-  gg->reset();
-
-  for (auto nd : gg->getNds()) {
-    // if we presolve, some edges may be blocked
-    for (auto e : nd->getAdjList()) {
-      e->pl().open();
-      e->pl().unblock();
+
+  // without a corridor, every solve would build the same problem
+  if (corridorRad <= 0 || noSolve) corridorIters = 1;
+
+  // station positions of the current solution, initially the heuristic one
+  NdPositions pos;
+  for (auto nd : cg.getNds()) pos[nd] = gg->getSettled(nd);
+
+  for (size_t iter = 0; iter < std::max<size_t>(corridorIters, 1); iter++) {
+    // extract first feasible solution from gridgraph
+    StarterSol sol = extractFeasibleSol(d, gg, cg, pos, maxGrDist);
+
+    bool restr = corridorRad > 0 || pruneSlack >= 0;
+
+    Corridors corridors;
+    if (restr) {
+      corridors = getCorridors(*d, gg, cg, pos, corridorRad, pruneSlack,
+                               maxGrDist);
     }
-    if (!nd->pl().isSink()) continue;
-    gg->openTurns(nd);
-    gg->closeSinkFr(nd);
-    gg->closeSinkTo(nd);
-  }
 
-  // clear drawing
-  d->crumble();
+    gg->reset();
 
-  auto lp = createProblem(gg, cg, geoPensMap, maxGrDist, solverStr);
+    for (auto nd : gg->getNds()) {
+      // if we presolve, some edges may be blocked
+      for (auto e : nd->getAdjList()) {
+        e->pl().open();
+        e->pl().unblock();
+      }
+      if (!nd->pl().isSink()) continue;
+      gg->openTurns(nd);
+      gg->closeSinkFr(nd);
+      gg->closeSinkTo(nd);
+    }
 
-  s.cols = lp->getNumVars();
-  s.rows = lp->getNumConstrs();
+    // keep the previous solution in case a later solve fails
+    Drawing prev = *d;
 
-  lp->setStarter(sol);
+    // clear drawing
+    d->crumble();
 
-  if (path.size()) {
-    std::string basename = path;
-    size_t pos = basename.find_last_of(".");
-    if (pos != std::string::npos) basename = basename.substr(0, pos);
+    ILPStats probStats;
+    auto lp = createProblem(gg, cg, geoPensMap, restr ? &corridors : 0,
+                            maxGrDist, solverStr, &probStats);
 
-    std::string outf = basename + ".sol";
-    std::string solutionF = basename + ".mst";
-    lp->writeMst(solutionF, sol);
-    lp->writeMps(path);
-  }
+    s.cols = std::max<size_t>(s.cols, lp->getNumVars());
+    s.rows = std::max<size_t>(s.rows, lp->getNumConstrs());
+    s.prunedCols = std::max(s.prunedCols, probStats.prunedCols);
+    s.prunedRows = std::max(s.prunedRows, probStats.prunedRows);
 
-  double time;
+    LOGTO(DEBUG, std::cerr) << "ILP iteration " << iter << " has "
+                            << lp->getNumVars() << " cols and "
+                            << lp->getNumConstrs() << " rows, pruned "
+                            << probStats.prunedCols << " cols and "
+                            << probStats.prunedRows << " rows";
+
+    lp->setStarter(sol);
+
+    if (path.size() && iter == 0) {
+      std::string basename = path;
+      size_t pos = basename.find_last_of(".");
+      if (pos != std::string::npos) basename = basename.substr(0, pos);
+
+      std::string outf = basename + ".sol";
+      std::string solutionF = basename + ".mst";
+      lp->writeMst(solutionF, sol);
+      lp->writeMps(path);
+    }
+
+    double time;
+
+    if (noSolve) {
+      delete lp;
+      break;
+    }
 
-  if (!noSolve) {
     if (timeLim >= 0) lp->setTimeLim(timeLim);
     if (cacheDir.size()) lp->setCacheDir(cacheDir);
     lp->setCacheThreshold(cacheThreshold);
@@ -76,24 +114,40 @@ ILPStats ILPGridOptimizer::optimize(BaseGraph* gg, const CombGraph& cg,
     T_START(ilp);
     auto status = lp->solve();
     time = T_STOP(ilp);
+    s.time += time;
 
     if (status == shared::optim::SolveType::INF) {
       delete lp;
-      throw std::runtime_error(
-          "No solution found for ILP problem (most likely because of a time "
-          "limit)!");
+
+      if (iter == 0) {
+        throw std::runtime_error(
+            "No solution found for ILP problem (most likely because of a time "
+            "limit)!");
+      }
+
+      // keep the solution of the previous iteration
+      *d = prev;
+      for (const auto& p : d->getEdgPaths()) {
+        for (auto xy : p.second) {
+          gg->addResEdg(const_cast<GridEdge*>(gg->getGrEdgById(xy)),
+                        const_cast<CombEdge*>(p.first));
+        }
+      }
+      break;
     }
 
-    extractSolution(lp, gg, cg, d);
-    shared::linegraph::LineGraph tg;
-    d->getLineGraph(&tg);
+    extractSolution(lp, gg, cg, d, &pos);
+
+    double prevScore = s.score;
 
     s.score = lp->getObjVal();
-    s.time = time;
     s.optimal = (status == shared::optim::SolveType::OPTIM);
-  }
 
-  delete lp;
+    delete lp;
+
+    // stop once the corridor no longer allows improvements
+    if (!(s.score < prevScore - 1e-6)) break;
+  }
 
   return s;
 }
@@ -101,8 +155,10 @@ ILPStats ILPGridOptimizer::optimize(BaseGraph* gg, const CombGraph& cg,
 // _____________________________________________________________________________
 ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
                                            const GeoPensMap* geoPensMap,
+                                           const Corridors* corridors,
                                            double maxGrDist,
-                                           const std::string& solverStr) const {
+                                           const std::string& solverStr,
+                                           ILPStats* stats) const {
   ILPSolver* lp = shared::optim::getSolver(solverStr, shared::optim::MIN);
 
   // grid nodes that may potentially be a position for an
@@ -133,6 +189,16 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
         continue;
       }
 
+      // the node must be reachable by all adjacent edges
+      bool reachable = true;
+      for (auto edg : nd->getAdjList()) {
+        if (!inCorridor(corridors, edg, n)) reachable = false;
+      }
+      if (!reachable) {
+        stats->prunedCols++;
+        continue;
+      }
+
       cands[nd].insert(n);
 
       gg->openSinkFr(const_cast<GridNode*>(n), 0);
@@ -171,18 +237,20 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
             continue;
           }
 
+          if (!inCorridor(corridors, edg, e->getFrom()) ||
+              !inCorridor(corridors, edg, e->getTo())) {
+            stats->prunedCols++;
+            continue;
+          }
+
           auto edgeVarName = getEdgUseVar(e, edg);
 
           double coef;
           if (geoPensMap && !e->pl().isSecondary()) {
-            // add geo pen
-            auto thisMap = geoPensMap->find(edg)->second;
-            auto i = thisMap.find(e->pl().getId());
-            if (i != thisMap.end()) coef = e->pl().cost() + i->second;
-
-            // if no geopen was present for grid edge, we assume SOFT_INF
-            // penalty
-            coef = e->pl().cost() + octi::basegraph::SOFT_INF;
+            // add geo pen, if no geopen was present for grid edge, this is
+            // SOFT_INF
+            const auto& pens = geoPensMap->find(edg)->second;
+            coef = e->pl().cost() + pens.get(e);
           } else {
             coef = e->pl().cost();
           }
@@ -207,7 +275,7 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
       std::stringstream constName;
       constName << "ue(" << e->getFrom()->pl().getId() << ","
                 << e->getTo()->pl().getId() << ")";
-      int row = lp->addRow(constName.str(), 1, shared::optim::UP);
+      std::vector<std::pair<int, double>> cols;
 
       for (auto nd : cg.getNds()) {
         for (auto edg : nd->getAdjList()) {
@@ -218,11 +286,15 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
           auto fVarName = getEdgUseVar(f, edg);
 
           int eCol = lp->getVarByName(eVarName);
-          if (eCol > -1) lp->addColToRow(row, eCol, 1);
+          if (eCol > -1) cols.push_back({eCol, 1});
           int fCol = lp->getVarByName(fVarName);
-          if (fCol > -1) lp->addColToRow(row, fCol, 1);
+          if (fCol > -1) cols.push_back({fCol, 1});
         }
       }
+
+      // a single used edge cannot violate this
+      addRow(lp, constName.str(), 1, shared::optim::UP, cols, 2,
+             &stats->prunedRows);
     }
   }
 
@@ -238,7 +310,7 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
         constName << "as(" << n->pl().getId() << "," << edg << ")";
 
         // an upper bound is enough here
-        int row = lp->addRow(constName.str(), 0, shared::optim::UP);
+        std::vector<std::pair<int, double>> cols;
 
         // normally, we count an incoming edge as 1 and an outgoing edge as -1
         // later on, we make sure that each node has a some of all out and in
@@ -263,12 +335,12 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
           // subtract the variable for this start node and edge, if used
           // as a candidate
           int ndColFrom = lp->getVarByName(getStatPosVar(n, edg->getFrom()));
-          if (ndColFrom > -1) lp->addColToRow(row, ndColFrom, -2);
+          if (ndColFrom > -1) cols.push_back({ndColFrom, -2});
 
           // add the variable for this end node and edge, if used
           // as a candidate
           int ndColTo = lp->getVarByName(getStatPosVar(n, edg->getTo()));
-          if (ndColTo > -1) lp->addColToRow(row, ndColTo, 1);
+          if (ndColTo > -1) cols.push_back({ndColTo, 1});
 
           outCost = 2;
         }
@@ -276,14 +348,17 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
         for (auto e : n->getAdjListIn()) {
           int edgCol = lp->getVarByName(getEdgUseVar(e, edg));
           if (edgCol < 0) continue;
-          lp->addColToRow(row, edgCol, inCost);
+          cols.push_back({edgCol, inCost});
         }
 
         for (auto e : n->getAdjListOut()) {
           int edgCol = lp->getVarByName(getEdgUseVar(e, edg));
           if (edgCol < 0) continue;
-          lp->addColToRow(row, edgCol, outCost);
+          cols.push_back({edgCol, outCost});
         }
+
+        addRow(lp, constName.str(), 0, shared::optim::UP, cols, 1,
+               &stats->prunedRows);
       }
     }
   }
@@ -304,7 +379,7 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
         std::stringstream constName;
         constName << "ss(" << n->pl().getId() << "," << e << ")";
 
-        int row = lp->addRow(constName.str(), 0, shared::optim::FIX);
+        std::vector<std::pair<int, double>> cols;
 
         if (!cands[e->getFrom()].count(n) && !cands[e->getTo()].count(n)) {
           // node does not appear as start or end cand, so the number of
@@ -313,12 +388,12 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
         } else {
           if (cands[e->getTo()].count(n)) {
             int ndColTo = lp->getVarByName(getStatPosVar(n, e->getTo()));
-            if (ndColTo > -1) lp->addColToRow(row, ndColTo, -1);
+            if (ndColTo > -1) cols.push_back({ndColTo, -1});
           }
 
           if (cands[e->getFrom()].count(n)) {
             int ndColFr = lp->getVarByName(getStatPosVar(n, e->getFrom()));
-            if (ndColFr > -1) lp->addColToRow(row, ndColFr, -1);
+            if (ndColFr > -1) cols.push_back({ndColFr, -1});
           }
         };
 
@@ -329,11 +404,14 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
           auto varSinkFr = getEdgUseVar(gg->getEdg(n, portNd), e);
 
           int ndColTo = lp->getVarByName(varSinkTo);
-          if (ndColTo > -1) lp->addColToRow(row, ndColTo, 1);
+          if (ndColTo > -1) cols.push_back({ndColTo, 1});
 
           int ndColFr = lp->getVarByName(varSinkFr);
-          if (ndColFr > -1) lp->addColToRow(row, ndColFr, 1);
+          if (ndColFr > -1) cols.push_back({ndColFr, 1});
         }
+
+        addRow(lp, constName.str(), 0, shared::optim::FIX, cols, 1,
+               &stats->prunedRows);
       }
     }
   }
@@ -346,14 +424,14 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
     std::stringstream constName;
     constName << "iu(" << n->pl().getId() << ")";
 
-    int row = lp->addRow(constName.str(), 1, shared::optim::UP);
+    std::vector<std::pair<int, double>> cols;
 
     // a meta grid node can either be a sink for a single input node, or
     // a pass-through
 
     for (auto nd : cg.getNds()) {
       int ndcolto = lp->getVarByName(getStatPosVar(n, nd).c_str());
-      if (ndcolto > -1) lp->addColToRow(row, ndcolto, 1);
+      if (ndcolto > -1) cols.push_back({ndcolto, 1});
     }
 
     // go over all ports
@@ -371,11 +449,14 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
 
             int edgCol = lp->getVarByName(getEdgUseVar(innerE, edg));
             if (edgCol < 0) continue;
-            lp->addColToRow(row, edgCol, 1);
+            cols.push_back({edgCol, 1});
           }
         }
       }
     }
+
+    addRow(lp, constName.str(), 1, shared::optim::UP, cols, 2,
+           &stats->prunedRows);
   }
 
   lp->update();
@@ -387,25 +468,28 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
     constName << "nc(" << rowId << ")";
     rowId++;
 
-    int row = lp->addRow(constName.str(), 1, shared::optim::UP);
+    std::vector<std::pair<int, double>> cols;
 
     for (auto nd : cg.getNds()) {
       for (auto edg : nd->getAdjList()) {
         if (edg->getFrom() != nd) continue;
 
         int col = lp->getVarByName(getEdgUseVar(edgPair.first.first, edg));
-        if (col > -1) lp->addColToRow(row, col, 1);
+        if (col > -1) cols.push_back({col, 1});
 
         col = lp->getVarByName(getEdgUseVar(edgPair.first.second, edg));
-        if (col > -1) lp->addColToRow(row, col, 1);
+        if (col > -1) cols.push_back({col, 1});
 
         col = lp->getVarByName(getEdgUseVar(edgPair.second.first, edg));
-        if (col > -1) lp->addColToRow(row, col, 1);
+        if (col > -1) cols.push_back({col, 1});
 
         col = lp->getVarByName(getEdgUseVar(edgPair.second.second, edg));
-        if (col > -1) lp->addColToRow(row, col, 1);
+        if (col > -1) cols.push_back({col, 1});
       }
     }
+
+    addRow(lp, constName.str(), 1, shared::optim::UP, cols, 2,
+           &stats->prunedRows);
   }
 
   lp->update();
@@ -620,6 +704,97 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
   return lp;
 }
 
+// _____________________________________________________________________________
+int ILPGridOptimizer::addRow(
+    ILPSolver* lp, const std::string& name, double bnd,
+    shared::optim::RowType type,
+    const std::vector<std::pair<int, double>>& cols, size_t minCols,
+    size_t* pruned) const {
+  if (cols.size() < minCols) {
+    (*pruned)++;
+    return -1;
+  }
+
+  int row = lp->addRow(name, bnd, type);
+  for (const auto& c : cols) lp->addColToRow(row, c.first, c.second);
+  return row;
+}
+
+// _____________________________________________________________________________
+Corridors ILPGridOptimizer::getCorridors(const Drawing& d, const BaseGraph* gg,
+                                         const CombGraph& cg,
+                                         const NdPositions& pos, double rad,
+                                         double pruneSlack,
+                                         double maxGrDist) const {
+  Corridors ret;
+  double cellSize = gg->getCellSize();
+
+  for (auto nd : cg.getNds()) {
+    for (auto ce : nd->getAdjList()) {
+      if (ce->getFrom() != nd) continue;
+      EdgCorridor& c = ret[ce];
+
+      c.a = *ce->getFrom()->pl().getGeom();
+      c.b = *ce->getTo()->pl().getGeom();
+
+      if (pruneSlack >= 0) {
+        // candidates are at most maxDis away from the input positions, so
+        // a path between two candidates with a detour of at most
+        // pruneSlack grid cells stays within this ellipse
+        double maxDis = cellSize * maxGrDist;
+        c.maxLen = util::geo::dist(c.a, c.b) + 4 * maxDis +
+                   pruneSlack * cellSize;
+      }
+
+      auto path = d.getEdgPaths().find(ce);
+      if (path == d.getEdgPaths().end()) continue;
+
+      auto fr = pos.find(ce->getFrom());
+      if (fr != pos.end() && fr->second) {
+        c.line.push_back(*fr->second->pl().getGeom());
+      }
+
+      // the path is stored starting at the target
+      for (auto it = path->second.rbegin(); it != path->second.rend(); it++) {
+        for (auto id : {it->first, it->second}) {
+          auto grNd = gg->getGrNdById(id)->pl().getParent();
+          const auto& geom = *grNd->pl().getGeom();
+          if (c.line.size() && util::geo::dist(c.line.back(), geom) == 0) {
+            continue;
+          }
+          c.line.push_back(geom);
+        }
+      }
+
+      auto to = pos.find(ce->getTo());
+      if (to != pos.end() && to->second) {
+        c.line.push_back(*to->second->pl().getGeom());
+      }
+
+      if (c.line.empty()) continue;
+      if (c.line.size() == 1) c.line.push_back(c.line.front());
+
+      c.box = util::geo::getBoundingBox(c.line);
+
+      // edges without a starter path are not restricted by the corridor
+      if (rad > 0) c.rad = rad * cellSize;
+    }
+  }
+
+  return ret;
+}
+
+// _____________________________________________________________________________
+bool ILPGridOptimizer::inCorridor(const Corridors* corridors,
+                                  const CombEdge* ce, const GridNode* n) const {
+  if (!corridors) return true;
+
+  auto c = corridors->find(ce);
+  if (c == corridors->end()) return true;
+
+  return c->second.contains(*n->pl().getParent()->pl().getGeom());
+}
+
 // _____________________________________________________________________________
 std::string ILPGridOptimizer::getEdgUseVar(const GridEdge* e,
                                            const CombEdge* cg) const {
@@ -642,8 +817,10 @@ std::string ILPGridOptimizer::getStatPosVar(const GridNode* n,
 // _____________________________________________________________________________
 void ILPGridOptimizer::extractSolution(ILPSolver* lp, BaseGraph* gg,
                                        const CombGraph& cg,
-                                       combgraph::Drawing* d) const {
-  std::map<const CombNode*, const GridNode*> gridNds;
+                                       combgraph::Drawing* d,
+                                       NdPositions* pos) const {
+  NdPositions& gridNds = *pos;
+  gridNds.clear();
   std::map<const CombEdge*, std::set<const GridEdge*>> gridEdgs;
 
   // write solution to grid graph
@@ -746,12 +923,14 @@ size_t ILPGridOptimizer::nonInfDeg(const GridNode* g) const {
 // _____________________________________________________________________________
 StarterSol ILPGridOptimizer::extractFeasibleSol(Drawing* d, BaseGraph* gg,
                                                 const CombGraph& cg,
+                                                const NdPositions& pos,
                                                 double maxGrDist) const {
   StarterSol sol;
 
   for (auto nd : cg.getNds()) {
     if (nd->getDeg() == 0) continue;
-    auto settled = gg->getSettled(nd);
+    auto it = pos.find(nd);
+    const GridNode* settled = it == pos.end() ? 0 : it->second;
 
     for (auto gnd : gg->getNds()) {
       if (!gnd->pl().isSink()) continue;
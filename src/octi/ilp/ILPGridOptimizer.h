@@ -5,11 +5,16 @@
 #ifndef OCTI_ILP_ILPGRIDOPTIMIZER_H_
 #define OCTI_ILP_ILPGRIDOPTIMIZER_H_
 
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
 #include <vector>
 #include "octi/basegraph/BaseGraph.h"
 #include "octi/combgraph/CombGraph.h"
 #include "octi/combgraph/Drawing.h"
 #include "shared/optim/ILPSolver.h"
+#include "util/geo/Geo.h"
 
 using octi::basegraph::BaseGraph;
 using octi::basegraph::GridEdge;
@@ -30,8 +35,43 @@ struct ILPStats {
   size_t rows = 0;
   size_t cols = 0;
   bool optimal = false;
+
+  // rows and cols not added to the model because they were pruned
+  size_t prunedRows = 0;
+  size_t prunedCols = 0;
+};
+
+// region of the grid the path of a comb edge is restricted to
+struct EdgCorridor {
+  // the path of the starter solution, nodes farther than rad away from it
+  // are outside if rad >= 0
+  util::geo::DLine line;
+  util::geo::DBox box;
+  double rad = -1;
+
+  // nodes p with dist(p, a) + dist(p, b) > maxLen are outside, unless they
+  // lie on the starter path
+  util::geo::DPoint a, b;
+  double maxLen = std::numeric_limits<double>::infinity();
+
+  bool contains(const util::geo::DPoint& p) const {
+    if (rad >= 0 && !nearLine(p, rad)) return false;
+    if (util::geo::dist(p, a) + util::geo::dist(p, b) <= maxLen) return true;
+
+    // never prune the starter solution
+    return nearLine(p, 1e-3);
+  }
+
+  bool nearLine(const util::geo::DPoint& p, double d) const {
+    if (line.empty()) return false;
+    if (!util::geo::contains(p, util::geo::pad(box, d))) return false;
+    return util::geo::dist(line, p) <= d;
+  }
 };
 
+typedef std::map<const CombEdge*, EdgCorridor> Corridors;
+typedef std::map<const CombNode*, const GridNode*> NdPositions;
+
 inline ILPStats operator+(const ILPStats& lh, const ILPStats& rh) {
   ILPStats ret;
   ret.score = lh.score + rh.score;
@@ -39,6 +79,8 @@ inline ILPStats operator+(const ILPStats& lh, const ILPStats& rh) {
   ret.rows = lh.rows + rh.rows;
   ret.cols = lh.cols + rh.cols;
   ret.optimal = lh.optimal && rh.optimal;
+  ret.prunedRows = lh.prunedRows + rh.prunedRows;
+  ret.prunedCols = lh.prunedCols + rh.prunedCols;
 
   return ret;
 }
@@ -47,9 +89,17 @@ class ILPGridOptimizer {
  public:
   ILPGridOptimizer() {}
 
+  // If corridorRad > 0, the path of each comb edge is restricted to grid
+  // nodes within corridorRad grid cells of its path in d. With
+  // corridorIters > 1, the problem is solved again in a corridor around the
+  // previous solution until it no longer improves. If pruneSlack >= 0, paths
+  // are also restricted to an ellipse around the comb edge endpoints which
+  // allows detours of pruneSlack grid cells.
   ILPStats optimize(BaseGraph* gg, const CombGraph& cg, combgraph::Drawing* d,
                     double maxGrDist, bool noSolve,
-                    const basegraph::GeoPensMap* geoPensMap, int timeLim,
+                    const basegraph::GeoPensMap* geoPensMap,
+                    double corridorRad, size_t corridorIters,
+                    double pruneSlack, int timeLim,
                     const std::string& cacheDir, double cacheThreshold,
                     int numThreads, const std::string& solverStr,
                     const std::string& path) const;
@@ -57,18 +107,35 @@ class ILPGridOptimizer {
  protected:
   shared::optim::ILPSolver* createProblem(
       BaseGraph* gg, const CombGraph& cg,
-      const basegraph::GeoPensMap* geoPensMap, double maxGrDist,
-      const std::string& solverStr) const;
+      const basegraph::GeoPensMap* geoPensMap, const Corridors* corridors,
+      double maxGrDist, const std::string& solverStr, ILPStats* stats) const;
+
+  Corridors getCorridors(const combgraph::Drawing& d, const BaseGraph* gg,
+                         const CombGraph& cg, const NdPositions& pos,
+                         double rad, double pruneSlack,
+                         double maxGrDist) const;
+
+  bool inCorridor(const Corridors* corridors, const CombEdge* ce,
+                  const GridNode* n) const;
+
+  // add a row with the given (column, coefficient) pairs, rows with less
+  // than minCols columns are skipped, counted in pruned, and -1 is returned
+  int addRow(shared::optim::ILPSolver* lp, const std::string& name, double bnd,
+             shared::optim::RowType type,
+             const std::vector<std::pair<int, double>>& cols, size_t minCols,
+             size_t* pruned) const;
 
   std::string getEdgUseVar(const GridEdge* e, const CombEdge* cg) const;
   std::string getStatPosVar(const GridNode* e, const CombNode* cg) const;
 
   void extractSolution(shared::optim::ILPSolver* lp, BaseGraph* gg,
-                       const CombGraph& cg, combgraph::Drawing* d) const;
+                       const CombGraph& cg, combgraph::Drawing* d,
+                       NdPositions* pos) const;
 
   shared::optim::StarterSol extractFeasibleSol(combgraph::Drawing* d,
                                                BaseGraph* gg,
                                                const CombGraph& cg,
+                                               const NdPositions& pos,
                                                double maxGrDist) const;
 
   size_t nonInfDeg(const GridNode* g) const;
@@ -0,0 +1,257 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "octi/basegraph/GridRouter.h"
+#include "octi/basegraph/OctiGridGraph.h"
+#include "octi/tests/DrawingTest.h"
+#include "shared/linegraph/LineGraph.h"
+#include "util/Misc.h"
+#include "util/graph/Dijkstra.h"
+
+#define private public
+#include "octi/combgraph/CombGraph.h"
+#include "octi/combgraph/Drawing.h"
+
+using octi::basegraph::BaseGraph;
+using octi::basegraph::GridEdge;
+using octi::basegraph::GridEdgePL;
+using octi::basegraph::GridNode;
+using octi::basegraph::GridNodePL;
+using octi::basegraph::GridRouter;
+using octi::basegraph::OctiGridGraph;
+using octi::basegraph::Penalties;
+using octi::combgraph::CombEdge;
+using octi::combgraph::CombGraph;
+using octi::combgraph::CombNode;
+using octi::combgraph::Drawing;
+using octi::combgraph::GrPath;
+using util::graph::Dijkstra;
+
+namespace {
+
+const double CELL_SIZE = 10;
+
+struct TestCost : public Dijkstra::CostFunc<GridNodePL, GridEdgePL, float> {
+  float operator()(const GridNode* from, const GridEdge* e,
+                   const GridNode* to) const {
+    UNUSED(from);
+    UNUSED(to);
+    return e->pl().cost();
+  }
+
+  float inf() const { return std::numeric_limits<float>::infinity(); }
+};
+
+struct ZeroHeur : public Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float> {
+  float operator()(const GridNode* from, const std::set<GridNode*>& to) const {
+    UNUSED(from);
+    UNUSED(to);
+    return 0;
+  }
+};
+
+// everything a rollback has to restore
+struct Snapshot {
+  double score;
+  uint64_t violations;
+  std::map<const CombEdge*, GrPath> paths;
+  std::map<const CombEdge*, double> edgCosts;
+  std::map<const CombNode*, double> ndBndCosts;
+  std::map<const CombNode*, double> ndReachCosts;
+};
+
+// _____________________________________________________________________________
+Snapshot snapshot(const Drawing& d, const CombGraph& cg) {
+  Snapshot ret;
+  ret.score = d.score();
+  ret.violations = d.violations();
+  ret.paths = d.getEdgPaths();
+  for (auto n : cg.getNds()) {
+    ret.ndBndCosts[n] = d.getNdBndCost(n);
+    ret.ndReachCosts[n] = d.getNdReachCost(n);
+    for (auto e : n->getAdjList()) ret.edgCosts[e] = d.getEdgCost(e);
+  }
+  return ret;
+}
+
+// _____________________________________________________________________________
+bool operator==(const Snapshot& a, const Snapshot& b) {
+  // infinite scores of empty drawings are equal
+  return a.score == b.score && a.violations == b.violations &&
+         a.paths == b.paths && a.edgCosts == b.edgCosts &&
+         a.ndBndCosts == b.ndBndCosts && a.ndReachCosts == b.ndReachCosts;
+}
+
+// _____________________________________________________________________________
+GridNode* grNd(const BaseGraph& gg, const CombNode* n) {
+  size_t x = std::round(n->pl().getGeom()->getX() / CELL_SIZE);
+  size_t y = std::round(n->pl().getGeom()->getY() / CELL_SIZE);
+
+  for (auto nd : gg.getNds()) {
+    if (nd->pl().isSink() && nd->pl().getX() == x && nd->pl().getY() == y) {
+      return nd;
+    }
+  }
+
+  assert(false);
+  return 0;
+}
+
+// _____________________________________________________________________________
+void drawEdg(Drawing* d, BaseGraph* gg, CombEdge* ce) {
+  auto fr = grNd(*gg, ce->getFrom());
+  auto to = grNd(*gg, ce->getTo());
+
+  gg->openSinkFr(fr, 0);
+  gg->openSinkTo(to, 0);
+
+  GridRouter router;
+  util::graph::EList<GridNodePL, GridEdgePL> eL;
+  util::graph::NList<GridNodePL, GridEdgePL> nL;
+  router.shortestPath({fr}, {to}, TestCost(), ZeroHeur(), &eL, &nL);
+  assert(eL.size());
+
+  d->draw(ce, eL, false);
+
+  gg->closeSinkTo(to);
+  gg->closeSinkFr(fr);
+}
+
+// _____________________________________________________________________________
+bool logEmpty(const Drawing& d) {
+  return d._log.checkpoints.empty() && d._log.nds.empty() &&
+         d._log.edgs.empty();
+}
+
+}  // namespace
+
+// _____________________________________________________________________________
+void DrawingTest::run() {
+  // a star, the center has degree 3 and is not contracted
+  shared::linegraph::LineGraph tg;
+  auto c = tg.addNd({{50.0, 50.0}});
+  auto a = tg.addNd({{10.0, 50.0}});
+  auto b = tg.addNd({{90.0, 50.0}});
+  auto d = tg.addNd({{50.0, 90.0}});
+
+  auto ca = tg.addEdg(c, a, {{{50.0, 50.0}, {10.0, 50.0}}});
+  auto cb = tg.addEdg(c, b, {{{50.0, 50.0}, {90.0, 50.0}}});
+  auto cd = tg.addEdg(c, d, {{{50.0, 50.0}, {50.0, 90.0}}});
+
+  shared::linegraph::Line l1("1", "1", "red");
+  ca->pl().addLine(&l1, 0);
+  cb->pl().addLine(&l1, 0);
+  cd->pl().addLine(&l1, 0);
+
+  CombGraph cg(&tg);
+
+  std::vector<CombEdge*> edgs;
+  for (auto n : cg.getNds()) {
+    for (auto e : n->getAdjList()) {
+      if (e->getFrom() == n) edgs.push_back(e);
+    }
+  }
+  assert(edgs.size() == 3);
+
+  OctiGridGraph gg(util::geo::DBox({0, 0}, {100, 100}), CELL_SIZE, 2,
+                   Penalties());
+  gg.init();
+
+  // ___________________________________________________________________________
+  // nested checkpoints
+  {
+    Drawing drawing(&gg);
+    drawEdg(&drawing, &gg, edgs[0]);
+    auto s0 = snapshot(drawing, cg);
+
+    drawing.checkpoint();
+    drawEdg(&drawing, &gg, edgs[1]);
+    auto s1 = snapshot(drawing, cg);
+    assert(!(s1 == s0));
+
+    drawing.checkpoint();
+    drawing.erase(edgs[0]);
+    drawEdg(&drawing, &gg, edgs[2]);
+    // redraw an edge drawn before the inner checkpoint
+    drawEdg(&drawing, &gg, edgs[1]);
+    drawing.erase(edgs[0]->getFrom());
+    assert(!(snapshot(drawing, cg) == s1));
+
+    drawing.rollback();
+    assert(snapshot(drawing, cg) == s1);
+
+    drawing.rollback();
+    assert(snapshot(drawing, cg) == s0);
+    assert(logEmpty(drawing));
+  }
+
+  // ___________________________________________________________________________
+  // commit inside rollback
+  {
+    Drawing drawing(&gg);
+    drawEdg(&drawing, &gg, edgs[0]);
+    auto s0 = snapshot(drawing, cg);
+
+    drawing.checkpoint();
+    drawEdg(&drawing, &gg, edgs[1]);
+
+    drawing.checkpoint();
+    drawing.erase(edgs[0]);
+    drawEdg(&drawing, &gg, edgs[2]);
+    auto s2 = snapshot(drawing, cg);
+
+    // the inner changes are kept, but still recorded for the outer
+    // checkpoint
+    drawing.commit();
+    assert(snapshot(drawing, cg) == s2);
+    assert(!logEmpty(drawing));
+
+    drawing.rollback();
+    assert(snapshot(drawing, cg) == s0);
+    assert(logEmpty(drawing));
+
+    // committing the outermost checkpoint drops the log
+    drawing.checkpoint();
+    drawEdg(&drawing, &gg, edgs[2]);
+    auto s3 = snapshot(drawing, cg);
+    drawing.commit();
+    assert(snapshot(drawing, cg) == s3);
+    assert(logEmpty(drawing));
+
+    // changes without a checkpoint are not recorded
+    drawEdg(&drawing, &gg, edgs[1]);
+    assert(logEmpty(drawing));
+  }
+
+  // ___________________________________________________________________________
+  // crumble() clears the log
+  {
+    Drawing drawing(&gg);
+    auto empty = snapshot(drawing, cg);
+
+    drawEdg(&drawing, &gg, edgs[0]);
+    drawing.checkpoint();
+    drawEdg(&drawing, &gg, edgs[1]);
+    drawing.checkpoint();
+    drawEdg(&drawing, &gg, edgs[2]);
+
+    drawing.crumble();
+    assert(logEmpty(drawing));
+    assert(snapshot(drawing, cg) == empty);
+    assert(drawing.score() == std::numeric_limits<double>::infinity());
+
+    // checkpoints after crumble() only see the crumbled drawing
+    drawing.checkpoint();
+    drawEdg(&drawing, &gg, edgs[0]);
+    drawing.rollback();
+    assert(snapshot(drawing, cg) == empty);
+    assert(logEmpty(drawing));
+  }
+}
@@ -0,0 +1,12 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#ifndef OCTI_TEST_DRAWINGTEST_H_
+#define OCTI_TEST_DRAWINGTEST_H_
+
+class DrawingTest {
+  public:
+    void run();
+};
+
+#endif
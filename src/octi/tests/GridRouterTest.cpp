@@ -0,0 +1,265 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <vector>
+
+#include "octi/basegraph/GridEdgePL.h"
+#include "octi/basegraph/GridNodePL.h"
+#include "octi/tests/GridRouterTest.h"
+#include "util/Misc.h"
+#include "util/graph/Dijkstra.h"
+#include "util/graph/DirGraph.h"
+
+#define private public
+#include "octi/basegraph/GridRouter.h"
+
+using octi::basegraph::GridEdge;
+using octi::basegraph::GridEdgePL;
+using octi::basegraph::GridNode;
+using octi::basegraph::GridNodePL;
+using octi::basegraph::GridRouter;
+using util::graph::Dijkstra;
+
+typedef util::graph::DirGraph<GridNodePL, GridEdgePL> TestGraph;
+typedef util::graph::EList<GridNodePL, GridEdgePL> EList;
+typedef util::graph::NList<GridNodePL, GridEdgePL> NList;
+typedef std::set<GridNode*> NdSet;
+
+namespace {
+
+struct TestCost : public Dijkstra::CostFunc<GridNodePL, GridEdgePL, float> {
+  float operator()(const GridNode* from, const GridEdge* e,
+                   const GridNode* to) const {
+    UNUSED(from);
+    UNUSED(to);
+    return e->pl().cost();
+  }
+
+  float inf() const { return std::numeric_limits<float>::infinity(); }
+};
+
+struct ZeroHeur : public Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float> {
+  float operator()(const GridNode* from, const NdSet& to) const {
+    UNUSED(from);
+    UNUSED(to);
+    return 0;
+  }
+};
+
+// the exact distance for every third node, 0 for all others. Admissible,
+// but not consistent.
+struct SpottyHeur : public Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float> {
+  SpottyHeur(const std::vector<float>& dists) : dists(dists) {}
+
+  float operator()(const GridNode* from, const NdSet& to) const {
+    UNUSED(to);
+    if (from->pl().getId() % 3) return 0;
+    return dists[from->pl().getId()];
+  }
+
+  std::vector<float> dists;
+};
+
+// _____________________________________________________________________________
+void buildGrid(TestGraph* g, std::vector<GridNode*>* nds, size_t w,
+               size_t h) {
+  for (size_t x = 0; x < w; x++) {
+    for (size_t y = 0; y < h; y++) {
+      auto n = g->addNd(GridNodePL({double(x), double(y)}));
+      n->pl().setId(nds->size());
+      n->pl().setXY(x, y);
+      nds->push_back(n);
+    }
+  }
+
+  // deterministic, direction dependent costs
+  size_t seed = 7;
+  auto nextCost = [&seed]() {
+    seed = (seed * 1103515245 + 12345) % 2147483648;
+    return 1.0 + (seed % 97) / 10.0;
+  };
+
+  for (size_t x = 0; x < w; x++) {
+    for (size_t y = 0; y < h; y++) {
+      auto n = (*nds)[x * h + y];
+      if (x + 1 < w) {
+        auto m = (*nds)[(x + 1) * h + y];
+        g->addEdg(n, m, GridEdgePL(nextCost(), false, false));
+        g->addEdg(m, n, GridEdgePL(nextCost(), false, false));
+      }
+      if (y + 1 < h) {
+        auto m = (*nds)[x * h + y + 1];
+        g->addEdg(n, m, GridEdgePL(nextCost(), false, false));
+        g->addEdg(m, n, GridEdgePL(nextCost(), false, false));
+      }
+    }
+  }
+}
+
+// _____________________________________________________________________________
+bool eq(float a, float b) { return fabs(a - b) < 0.001; }
+
+// _____________________________________________________________________________
+void checkPath(const NdSet& from, const NdSet& to, float cost,
+               const EList& eL, const NList& nL) {
+  // like util::graph::Dijkstra, paths are written starting at the target
+  assert(nL.size() == eL.size() + 1);
+  assert(to.count(nL.front()));
+  assert(from.count(nL.back()));
+
+  float sum = 0;
+  for (size_t i = 0; i < eL.size(); i++) {
+    assert(eL[i]->getTo() == nL[i]);
+    assert(eL[i]->getFrom() == nL[i + 1]);
+    sum += eL[i]->pl().cost();
+  }
+
+  assert(eq(sum, cost));
+}
+
+// _____________________________________________________________________________
+std::vector<float> distsTo(const std::vector<GridNode*>& nds, const NdSet& to) {
+  std::vector<float> ret;
+  for (auto n : nds) {
+    EList eL;
+    NList nL;
+    ret.push_back(
+        Dijkstra::shortestPath(NdSet{n}, to, TestCost(), ZeroHeur(), &eL, &nL));
+  }
+  return ret;
+}
+
+// _____________________________________________________________________________
+std::vector<float> distsFrom(const std::vector<GridNode*>& nds,
+                             const NdSet& from) {
+  std::vector<float> ret;
+  for (auto n : nds) {
+    EList eL;
+    NList nL;
+    ret.push_back(Dijkstra::shortestPath(from, NdSet{n}, TestCost(), ZeroHeur(),
+                                         &eL, &nL));
+  }
+  return ret;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________
+void GridRouterTest::run() {
+  TestGraph g;
+  std::vector<GridNode*> nds;
+  buildGrid(&g, &nds, 7, 5);
+
+  std::vector<std::pair<NdSet, NdSet>> queries = {
+      {{nds[0]}, {nds[34]}},
+      {{nds[34]}, {nds[0]}},
+      {{nds[4]}, {nds[30]}},
+      {{nds[17]}, {nds[17]}},
+      {{nds[0], nds[1], nds[5]}, {nds[33], nds[28]}},
+      {{nds[12], nds[22]}, {nds[2], nds[32], nds[3]}},
+      {{nds[6]}, {nds[7]}}};
+
+  // ___________________________________________________________________________
+  // unidirectional
+  {
+    GridRouter router;
+
+    for (const auto& q : queries) {
+      EList eLRef;
+      NList nLRef;
+      float ref = Dijkstra::shortestPath(q.first, q.second, TestCost(),
+                                         ZeroHeur(), &eLRef, &nLRef);
+
+      EList eL;
+      NList nL;
+      float c =
+          router.shortestPath(q.first, q.second, TestCost(), ZeroHeur(), &eL,
+                              &nL);
+      assert(eq(c, ref));
+      checkPath(q.first, q.second, c, eL, nL);
+
+      // settled nodes have to be re-opened for inconsistent heuristics
+      eL.clear();
+      nL.clear();
+      SpottyHeur heur(distsTo(nds, q.second));
+      c = router.shortestPath(q.first, q.second, TestCost(), heur, &eL, &nL);
+      assert(eq(c, ref));
+      checkPath(q.first, q.second, c, eL, nL);
+    }
+  }
+
+  // ___________________________________________________________________________
+  // bidirectional
+  {
+    GridRouter router;
+
+    for (const auto& q : queries) {
+      EList eLRef;
+      NList nLRef;
+      float ref = Dijkstra::shortestPath(q.first, q.second, TestCost(),
+                                         ZeroHeur(), &eLRef, &nLRef);
+
+      EList eL;
+      NList nL;
+      float c = router.biShortestPath(q.first, q.second, TestCost(),
+                                      ZeroHeur(), ZeroHeur(), &eL, &nL);
+      assert(eq(c, ref));
+      checkPath(q.first, q.second, c, eL, nL);
+
+      eL.clear();
+      nL.clear();
+      SpottyHeur heur(distsTo(nds, q.second));
+      SpottyHeur revHeur(distsFrom(nds, q.first));
+      c = router.biShortestPath(q.first, q.second, TestCost(), heur, revHeur,
+                                &eL, &nL);
+      assert(eq(c, ref));
+      checkPath(q.first, q.second, c, eL, nL);
+    }
+  }
+
+  // ___________________________________________________________________________
+  // generation counter wraparound
+  {
+    GridRouter router;
+
+    EList eL;
+    NList nL;
+    router.shortestPath(queries[0].first, queries[0].second, TestCost(),
+                        ZeroHeur(), &eL, &nL);
+
+    // the state of the last query must not leak into the queries after the
+    // counter wrapped around
+    router._gen = std::numeric_limits<uint32_t>::max() - 2;
+
+    for (size_t i = 0; i < 2 * queries.size(); i++) {
+      const auto& q = queries[i % queries.size()];
+
+      EList eLRef;
+      NList nLRef;
+      float ref = Dijkstra::shortestPath(q.first, q.second, TestCost(),
+                                         ZeroHeur(), &eLRef, &nLRef);
+
+      eL.clear();
+      nL.clear();
+      float c;
+      if (i % 2) {
+        c = router.biShortestPath(q.first, q.second, TestCost(), ZeroHeur(),
+                                  ZeroHeur(), &eL, &nL);
+      } else {
+        c = router.shortestPath(q.first, q.second, TestCost(), ZeroHeur(),
+                                &eL, &nL);
+      }
+      assert(eq(c, ref));
+      checkPath(q.first, q.second, c, eL, nL);
+    }
+
+    assert(router._gen > 0);
+    assert(router._gen < queries.size() * 2);
+    assert(router.numQueries() == 1 + 2 * queries.size());
+  }
+}
@@ -0,0 +1,12 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#ifndef OCTI_TEST_GRIDROUTERTEST_H_
+#define OCTI_TEST_GRIDROUTERTEST_H_
+
+class GridRouterTest {
+  public:
+    void run();
+};
+
+#endif
@@ -0,0 +1,214 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <vector>
+
+#include "octi/basegraph/GridGraph.h"
+#include "octi/basegraph/GridRouter.h"
+#include "octi/basegraph/OctiGridGraph.h"
+#include "octi/combgraph/CombGraph.h"
+#include "octi/combgraph/Drawing.h"
+#include "octi/tests/ReWindowTest.h"
+#include "shared/linegraph/LineGraph.h"
+#include "util/Misc.h"
+#include "util/graph/Dijkstra.h"
+
+using octi::basegraph::BaseGraph;
+using octi::basegraph::GridEdge;
+using octi::basegraph::GridEdgePL;
+using octi::basegraph::GridGraph;
+using octi::basegraph::GridNode;
+using octi::basegraph::GridNodePL;
+using octi::basegraph::GridRouter;
+using octi::basegraph::OctiGridGraph;
+using octi::basegraph::Penalties;
+using octi::combgraph::CombEdge;
+using octi::combgraph::CombGraph;
+using octi::combgraph::CombNode;
+using octi::combgraph::Drawing;
+using util::geo::DBox;
+using util::graph::Dijkstra;
+
+namespace {
+
+const double CELL_SIZE = 10;
+
+// the drawing is done on this box
+const DBox BOX_A({0, 0}, {100, 100});
+
+// same extent as BOX_A, so the grid dimensions match. The offsets are
+// exactly representable, so the extent is exactly the same.
+const DBox BOX_B({1000.25, -517.75}, {1100.25, -417.75});
+
+// different extent, a graph cannot be moved here
+const DBox BOX_C({0, 0}, {150, 100});
+
+struct TestCost : public Dijkstra::CostFunc<GridNodePL, GridEdgePL, float> {
+  float operator()(const GridNode* from, const GridEdge* e,
+                   const GridNode* to) const {
+    UNUSED(from);
+    UNUSED(to);
+    return e->pl().cost();
+  }
+
+  float inf() const { return std::numeric_limits<float>::infinity(); }
+};
+
+struct ZeroHeur : public Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float> {
+  float operator()(const GridNode* from, const std::set<GridNode*>& to) const {
+    UNUSED(from);
+    UNUSED(to);
+    return 0;
+  }
+};
+
+// _____________________________________________________________________________
+GridNode* grNd(const BaseGraph& gg, const CombNode* n) {
+  size_t x = std::round(n->pl().getGeom()->getX() / CELL_SIZE);
+  size_t y = std::round(n->pl().getGeom()->getY() / CELL_SIZE);
+
+  for (auto nd : gg.getNds()) {
+    if (nd->pl().isSink() && nd->pl().getX() == x && nd->pl().getY() == y) {
+      return nd;
+    }
+  }
+
+  assert(false);
+  return 0;
+}
+
+// _____________________________________________________________________________
+// draw all edges of cg into gg and settle the drawing on the grid
+void drawAll(const CombGraph& cg, BaseGraph* gg) {
+  Drawing d(gg);
+
+  for (auto n : cg.getNds()) {
+    for (auto ce : n->getAdjList()) {
+      if (ce->getFrom() != n) continue;
+      auto fr = grNd(*gg, ce->getFrom());
+      auto to = grNd(*gg, ce->getTo());
+
+      gg->openSinkFr(fr, 0);
+      gg->openSinkTo(to, 0);
+
+      GridRouter router;
+      util::graph::EList<GridNodePL, GridEdgePL> eL;
+      util::graph::NList<GridNodePL, GridEdgePL> nL;
+      router.shortestPath({fr}, {to}, TestCost(), ZeroHeur(), &eL, &nL);
+      assert(eL.size());
+
+      d.draw(ce, eL, false);
+
+      gg->closeSinkTo(to);
+      gg->closeSinkFr(fr);
+    }
+  }
+
+  d.applyToGrid(gg);
+}
+
+// _____________________________________________________________________________
+// check that moved and fresh are indistinguishable
+void checkEq(const BaseGraph& moved, const BaseGraph& fresh,
+             const CombGraph& cg) {
+  assert(moved.getNds().size() == fresh.getNds().size());
+
+  for (auto n : fresh.getNds()) {
+    auto m = moved.getGrNdById(n->pl().getId());
+    assert(m);
+
+    assert(m->pl().getGeom()->getX() == n->pl().getGeom()->getX());
+    assert(m->pl().getGeom()->getY() == n->pl().getGeom()->getY());
+    assert(m->pl().isSink() == n->pl().isSink());
+    assert(m->pl().isSettled() == n->pl().isSettled());
+    assert(m->pl().isClosed() == n->pl().isClosed());
+    assert(m->getAdjListOut().size() == n->getAdjListOut().size());
+
+    if (n->pl().isSink()) {
+      assert(m->pl().getX() == n->pl().getX());
+      assert(m->pl().getY() == n->pl().getY());
+      for (size_t i = 0; i < fresh.maxDeg(); i++) {
+        auto p = n->pl().getPort(i);
+        auto q = m->pl().getPort(i);
+        assert((p == 0) == (q == 0));
+        if (p) assert(p->pl().getId() == q->pl().getId());
+      }
+    }
+
+    for (auto e : n->getAdjListOut()) {
+      auto f = moved.getNEdg(m, moved.getGrNdById(e->getTo()->pl().getId()));
+      assert(f);
+      assert(f->pl().getId() == e->pl().getId());
+      // cost() covers the closed and blocked state. Not compared directly, as
+      // sink edges of a fresh graph are open with infinite cost, while reset()
+      // closes them.
+      assert(f->pl().cost() == e->pl().cost());
+      assert(f->pl().rawCost() == e->pl().rawCost());
+      assert(f->pl().isSecondary() == e->pl().isSecondary());
+      assert(f->pl().resEdgs() == e->pl().resEdgs());
+    }
+  }
+
+  for (auto n : cg.getNds()) assert(moved.getSettled(n) == 0);
+}
+
+// _____________________________________________________________________________
+void check(BaseGraph* moved, BaseGraph* fresh, const CombGraph& cg) {
+  moved->init();
+  fresh->init();
+
+  // leave everything a finished drawing leaves behind
+  drawAll(cg, moved);
+  moved->addObstacle(util::geo::Polygon<double>(
+      util::geo::Line<double>{{30, 30}, {40, 30}, {40, 40}, {30, 40}}));
+
+  assert(moved->reWindow(BOX_B));
+  checkEq(*moved, *fresh, cg);
+
+  // a failed attempt leaves the graph untouched
+  assert(!moved->reWindow(BOX_C));
+  checkEq(*moved, *fresh, cg);
+}
+
+}  // namespace
+
+// _____________________________________________________________________________
+void ReWindowTest::run() {
+  // a star, the center has degree 3 and is not contracted
+  shared::linegraph::LineGraph tg;
+  auto c = tg.addNd({{50.0, 50.0}});
+  auto a = tg.addNd({{10.0, 50.0}});
+  auto b = tg.addNd({{90.0, 50.0}});
+  auto d = tg.addNd({{50.0, 90.0}});
+
+  auto ca = tg.addEdg(c, a, {{{50.0, 50.0}, {10.0, 50.0}}});
+  auto cb = tg.addEdg(c, b, {{{50.0, 50.0}, {90.0, 50.0}}});
+  auto cd = tg.addEdg(c, d, {{{50.0, 50.0}, {50.0, 90.0}}});
+
+  shared::linegraph::Line l1("1", "1", "red");
+  ca->pl().addLine(&l1, 0);
+  cb->pl().addLine(&l1, 0);
+  cd->pl().addLine(&l1, 0);
+
+  CombGraph cg(&tg);
+
+  // ___________________________________________________________________________
+  // octilinear grid
+  {
+    OctiGridGraph moved(BOX_A, CELL_SIZE, 2, Penalties());
+    OctiGridGraph fresh(BOX_B, CELL_SIZE, 2, Penalties());
+    check(&moved, &fresh, cg);
+  }
+
+  // ___________________________________________________________________________
+  // orthogonal grid
+  {
+    GridGraph moved(BOX_A, CELL_SIZE, 2, Penalties());
+    GridGraph fresh(BOX_B, CELL_SIZE, 2, Penalties());
+    check(&moved, &fresh, cg);
+  }
+}
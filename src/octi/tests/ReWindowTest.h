@@ -0,0 +1,12 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#ifndef OCTI_TEST_REWINDOWTEST_H_
+#define OCTI_TEST_REWINDOWTEST_H_
+
+class ReWindowTest {
+  public:
+    void run();
+};
+
+#endif
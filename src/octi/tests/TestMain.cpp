@@ -1,12 +1,23 @@
 // Copyright 2016
 // Author: Patrick Brosi
 
+#include "octi/tests/DrawingTest.h"
+#include "octi/tests/GridRouterTest.h"
+#include "octi/tests/ReWindowTest.h"
+
 #include "util/Misc.h"
 
 // _____________________________________________________________________________
 int main(int argc, char** argv) {
   UNUSED(argc);
   UNUSED(argv);
+  GridRouterTest grt;
+  DrawingTest dt;
+  ReWindowTest rwt;
+
+  grt.run();
+  dt.run();
+  rwt.run();
 
   return 0;
 }
@@ -1569,6 +1569,34 @@ std::vector<LineGraph> LineGraph::distConnectedComponents(double d, bool write,
   return ret;
 }
 
+// _____________________________________________________________________________
+void LineGraph::copyTo(LineGraph* target) const {
+  std::unordered_map<const LineNode*, LineNode*> nm;
+
+  target->_lines = _lines;
+
+  for (auto nd : getNds()) {
+    nm[nd] = target->addNd(nd->pl());
+    target->expandBBox(*nd->pl().getGeom());
+  }
+
+  for (auto nd : getNds()) {
+    for (auto edg : nd->getAdjList()) {
+      if (edg->getFrom() != nd) continue;
+
+      auto newEdg = target->addEdg(nm[edg->getFrom()], nm[edg->getTo()],
+                                   edg->pl());
+      target->expandBBox(edg->pl().getGeom()->front());
+      target->expandBBox(edg->pl().getGeom()->back());
+
+      edgeRpl(newEdg->getFrom(), edg, newEdg);
+      edgeRpl(newEdg->getTo(), edg, newEdg);
+      nodeRpl(newEdg, edg->getTo(), nm[edg->getTo()]);
+      nodeRpl(newEdg, edg->getFrom(), nm[edg->getFrom()]);
+    }
+  }
+}
+
 // _____________________________________________________________________________
 void LineGraph::snapOrphanStations() {
   double MAXD = 1;
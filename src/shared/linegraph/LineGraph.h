@@ -170,6 +170,10 @@ class LineGraph : public util::graph::UndirGraph<LineNodePL, LineEdgePL> {
   std::vector<LineGraph> distConnectedComponents(double d, bool write,
                                                  size_t* offset);
 
+  // write a deep copy of this graph into the empty graph target, lines are
+  // shared
+  void copyTo(LineGraph* target) const;
+
   void fillMissingColors();
 
   void removeDeg1Nodes();
@@ -93,7 +93,7 @@ class LineNodePL : util::geograph::GeoNodePL<double> {
   bool lineServed(const Line* r) const;
   void setNotServed(const NotServedLines& notServed);
 
-  const NotServedLines& getLinesNotServed() { return _notServed; }
+  const NotServedLines& getLinesNotServed() const { return _notServed; }
 
   void clearConnExc();
 
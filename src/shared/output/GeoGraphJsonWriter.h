@@ -0,0 +1,318 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef SHARED_OUTPUT_GEOGRAPHJSONWRITER_H_
+#define SHARED_OUTPUT_GEOGRAPHJSONWRITER_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "util/String.h"
+#include "util/geo/Geo.h"
+#include "util/graph/Graph.h"
+#include "util/json/Writer.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_max_threads() 1
+#endif
+
+namespace shared {
+namespace output {
+
+// number of features formatted into a single chunk
+static const size_t FEATURE_CHUNK_SIZE = 2048;
+
+// precision used for attribute values and, by default, for coordinates
+static const int ATTR_PRECISION = 10;
+
+// _____________________________________________________________________________
+// Format d with prec >= 0 decimal places into buf (at least 64 chars) and
+// strip trailing zeros, return the number of chars written. This gives the
+// same output as util::json::Writer and printf's %.*f, including the
+// rounding of ties to even. Values of magnitude 1e32 or more are written in
+// exponent notation.
+inline size_t fmtDouble(double d, int prec, char* buf) {
+  static const double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                 1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15};
+
+  if (!std::isfinite(d)) {
+    // not representable in JSON
+    memcpy(buf, "null", 4);
+    return 4;
+  }
+
+  if (prec > 15) prec = 15;
+
+  double a = fabs(d);
+  double scaled = a * POW10[prec];
+
+  // fall back to printf if we cannot do this in integer arithmetic
+  if (scaled >= 9007199254740992.0) {
+    if (a >= 1e32) return snprintf(buf, 64, "%.17g", d);
+
+    size_t n = snprintf(buf, 64, "%.*f", prec, d);
+    if (prec) {
+      while (buf[n - 1] == '0') n--;
+      if (buf[n - 1] == '.') n--;
+    }
+    return n;
+  }
+
+  // the exact product is scaled + err, round it half to even
+  double err = std::fma(a, POW10[prec], -scaled);
+  double intScaled = std::floor(scaled);
+  double t = (scaled - intScaled) - 0.5;
+
+  uint64_t v = static_cast<uint64_t>(intScaled);
+  if (t > -err || (t == -err && (v & 1))) v++;
+
+  uint64_t p = static_cast<uint64_t>(POW10[prec]);
+  uint64_t intPart = v / p;
+  uint64_t fracPart = v % p;
+
+  char tmp[24];
+  size_t n = 0;
+
+  if (std::signbit(d)) buf[n++] = '-';
+
+  size_t i = 0;
+  do {
+    tmp[i++] = '0' + (intPart % 10);
+    intPart /= 10;
+  } while (intPart);
+  while (i) buf[n++] = tmp[--i];
+
+  if (fracPart) {
+    // strip trailing zeros
+    int digits = prec;
+    while (fracPart % 10 == 0) {
+      fracPart /= 10;
+      digits--;
+    }
+
+    buf[n++] = '.';
+    for (int j = digits - 1; j >= 0; j--) {
+      buf[n + j] = '0' + (fracPart % 10);
+      fracPart /= 10;
+    }
+    n += digits;
+  }
+
+  return n;
+}
+
+// Writes graphs as a GeoJSON feature collection in lat/lng. Features are
+// formatted in chunks in parallel and written to the output stream in the
+// same order a sequential GeoGraphJsonOutput would produce.
+class GeoGraphJsonWriter {
+ public:
+  GeoGraphJsonWriter(std::ostream* out, int prec)
+      : _out(out), _prec(prec), _first(true), _closed(false) {
+    (*_out) << "{\"type\":\"FeatureCollection\",\"features\":[\n";
+  }
+
+  GeoGraphJsonWriter(std::ostream* out, int prec, const util::json::Val& attrs)
+      : _out(out), _prec(prec), _first(true), _closed(false) {
+    (*_out) << "{\"type\":\"FeatureCollection\",\"properties\":";
+    std::stringstream ss;
+    util::json::Writer wr(&ss, ATTR_PRECISION, false);
+    wr.val(attrs);
+    (*_out) << ss.str() << ",\"features\":[\n";
+  }
+
+  ~GeoGraphJsonWriter() { flush(); }
+
+  // print all nodes and edges of a graph
+  template <typename N, typename E>
+  void printLatLng(const util::graph::Graph<N, E>& g) {
+    printLatLng(g, util::json::Dict());
+  }
+
+  // print all nodes and edges of a graph, adding props to each feature
+  template <typename N, typename E>
+  void printLatLng(const util::graph::Graph<N, E>& g,
+                   const util::json::Dict& props) {
+    std::vector<const util::graph::Node<N, E>*> nds(g.getNds().begin(),
+                                                    g.getNds().end());
+
+    // first pass, nodes
+    printChunked(nds.size(),
+                 [&](size_t i, std::string* buf, std::stringstream* ss) {
+                   printNd(nds[i], props, buf, ss);
+                 });
+
+    // second pass, edges
+    std::vector<const util::graph::Edge<N, E>*> edgs;
+    for (auto n : nds) {
+      for (auto e : n->getAdjListOut()) {
+        // to avoid double output for undirected graphs
+        if (e->getFrom() != n) continue;
+        edgs.push_back(e);
+      }
+    }
+
+    printChunked(edgs.size(),
+                 [&](size_t i, std::string* buf, std::stringstream* ss) {
+                   printEdg(edgs[i], props, buf, ss);
+                 });
+  }
+
+  // print an already serialized GeoJSON feature
+  void printRaw(const std::string& feature) {
+    if (!_first) (*_out) << ",\n";
+    _first = false;
+    _out->write(feature.data(), feature.size());
+  }
+
+  // close the feature collection and flush the output stream
+  void flush() {
+    if (_closed) return;
+    (*_out) << "\n]}\n";
+    _out->flush();
+    _closed = true;
+  }
+
+ private:
+  std::ostream* _out;
+  int _prec;
+  bool _first;
+  bool _closed;
+
+  // ___________________________________________________________________________
+  template <typename F>
+  void printChunked(size_t num, F fmt) {
+    if (num == 0) return;
+
+    size_t numChunks = (num + FEATURE_CHUNK_SIZE - 1) / FEATURE_CHUNK_SIZE;
+
+    // only keep a bounded number of chunks in memory at once
+    size_t batchSize = 4 * omp_get_max_threads();
+    std::vector<std::string> bufs(std::min(batchSize, numChunks));
+
+    for (size_t batch = 0; batch < numChunks; batch += batchSize) {
+      size_t batchEnd = std::min(numChunks, batch + batchSize);
+
+#pragma omp parallel for schedule(dynamic)
+      for (size_t c = batch; c < batchEnd; c++) {
+        std::string& buf = bufs[c - batch];
+        buf.clear();
+
+        // scratch stream for the attributes, shared by the whole chunk
+        std::stringstream ss;
+
+        size_t end = std::min(num, (c + 1) * FEATURE_CHUNK_SIZE);
+        for (size_t i = c * FEATURE_CHUNK_SIZE; i < end; i++) {
+          size_t len = buf.size();
+          if (len) buf.append(",\n");
+          size_t start = buf.size();
+          fmt(i, &buf, &ss);
+          // feature was skipped, drop the separator again
+          if (buf.size() == start) buf.resize(len);
+        }
+      }
+
+      for (size_t c = batch; c < batchEnd; c++) {
+        const auto& buf = bufs[c - batch];
+        if (buf.empty()) continue;
+        if (!_first) _out->write(",\n", 2);
+        _first = false;
+        _out->write(buf.data(), buf.size());
+      }
+    }
+  }
+
+  // ___________________________________________________________________________
+  template <typename N, typename E>
+  void printNd(const util::graph::Node<N, E>* n, const util::json::Dict& props,
+               std::string* buf, std::stringstream* ss) const {
+    if (!n->pl().getGeom()) return;
+
+    util::json::Dict attrs{
+        {"id", util::toString(n)},
+        {"deg", util::toString(n->getInDeg() + n->getOutDeg())},
+        {"deg_out", util::toString(n->getOutDeg())},
+        {"deg_in", util::toString(n->getInDeg())}};
+
+    auto addProps = n->pl().getAttrs();
+    attrs.insert(addProps.begin(), addProps.end());
+    attrs.insert(props.begin(), props.end());
+
+    buf->append("{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\","
+                "\"coordinates\":");
+    printCoord(*n->pl().getGeom(), buf);
+    buf->append("},\"properties\":");
+    printAttrs(attrs, buf, ss);
+    buf->push_back('}');
+  }
+
+  // ___________________________________________________________________________
+  template <typename N, typename E>
+  void printEdg(const util::graph::Edge<N, E>* e, const util::json::Dict& props,
+                std::string* buf, std::stringstream* ss) const {
+    util::json::Dict attrs{{"from", util::toString(e->getFrom())},
+                           {"to", util::toString(e->getTo())},
+                           {"id", util::toString(e)}};
+
+    auto addProps = e->pl().getAttrs();
+    attrs.insert(addProps.begin(), addProps.end());
+    attrs.insert(props.begin(), props.end());
+
+    util::geo::Line<double> line;
+    if (!e->pl().getGeom() || !e->pl().getGeom()->size()) {
+      if (!e->getFrom()->pl().getGeom() || !e->getTo()->pl().getGeom()) return;
+      line = {*e->getFrom()->pl().getGeom(), *e->getTo()->pl().getGeom()};
+    }
+
+    const auto& geom = line.size() ? line : *e->pl().getGeom();
+
+    buf->append("{\"type\":\"Feature\",\"geometry\":{\"type\":\"LineString\","
+                "\"coordinates\":[");
+    for (size_t i = 0; i < geom.size(); i++) {
+      if (i) buf->push_back(',');
+      printCoord(geom[i], buf);
+    }
+    buf->append("]},\"properties\":");
+    printAttrs(attrs, buf, ss);
+    buf->push_back('}');
+  }
+
+  // ___________________________________________________________________________
+  void printCoord(const util::geo::Point<double>& p, std::string* buf) const {
+    char tmp[64];
+    auto ll = util::geo::webMercToLatLng<double>(p.getX(), p.getY());
+
+    // by default, same formatting as util's GeoJsonOutput
+    int prec = _prec < 0 ? ATTR_PRECISION : _prec;
+
+    buf->push_back('[');
+    buf->append(tmp, fmtDouble(ll.getX(), prec, tmp));
+    buf->push_back(',');
+    buf->append(tmp, fmtDouble(ll.getY(), prec, tmp));
+    buf->push_back(']');
+  }
+
+  // ___________________________________________________________________________
+  void printAttrs(const util::json::Dict& attrs, std::string* buf,
+                  std::stringstream* ss) const {
+    ss->str("");
+    ss->clear();
+    util::json::Writer wr(ss, ATTR_PRECISION, false);
+    wr.val(attrs);
+    buf->append(ss->str());
+  }
+};
+
+}  // namespace output
+}  // namespace shared
+
+#endif  // SHARED_OUTPUT_GEOGRAPHJSONWRITER_H_
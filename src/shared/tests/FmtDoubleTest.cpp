@@ -0,0 +1,106 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include "shared/output/GeoGraphJsonWriter.h"
+#include "shared/tests/FmtDoubleTest.h"
+
+using shared::output::fmtDouble;
+
+namespace {
+
+// _____________________________________________________________________________
+std::string fmt(double d, int prec) {
+  char buf[64];
+  return std::string(buf, fmtDouble(d, prec, buf));
+}
+
+// _____________________________________________________________________________
+std::string printfFmt(double d, int prec) {
+  char buf[512];
+  std::string ret(buf, snprintf(buf, 512, "%.*f", prec, d));
+  if (prec) {
+    while (ret.back() == '0') ret.pop_back();
+    if (ret.back() == '.') ret.pop_back();
+  }
+  return ret;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________
+void FmtDoubleTest::run() {
+  // ___________________________________________________________________________
+  // rounding
+  {
+    assert(fmt(1.23456789014, 10) == "1.2345678901");
+    assert(fmt(1.23456789016, 10) == "1.2345678902");
+    assert(fmt(0.99999999999, 10) == "1");
+    assert(fmt(7.5, 0) == "8");
+
+    // exact ties are rounded to even
+    assert(fmt(0.125, 2) == "0.12");
+    assert(fmt(0.375, 2) == "0.38");
+    assert(fmt(12.5, 0) == "12");
+
+    // rounded by the exact binary value, 2.675 is 2.67499999...
+    assert(fmt(2.675, 2) == "2.67");
+    assert(fmt(1.005, 2) == "1");
+  }
+
+  // ___________________________________________________________________________
+  // negative values
+  {
+    assert(fmt(-7.25, 10) == "-7.25");
+    assert(fmt(-2.675, 2) == "-2.67");
+    assert(fmt(-180, 10) == "-180");
+    assert(fmt(-0.5, 0) == "-0");
+    assert(fmt(-1e-11, 10) == "-0");
+  }
+
+  // ___________________________________________________________________________
+  // trailing zeros
+  {
+    assert(fmt(5, 10) == "5");
+    assert(fmt(0, 10) == "0");
+    assert(fmt(100, 3) == "100");
+    assert(fmt(0.1, 10) == "0.1");
+    assert(fmt(5.5, 10) == "5.5");
+    assert(fmt(0.0000000001, 10) == "0.0000000001");
+    assert(fmt(3.1400000001, 10) == "3.1400000001");
+    assert(fmt(3.14, 0) == "3");
+  }
+
+  // ___________________________________________________________________________
+  // values which cannot be scaled to an integer below 2^53
+  {
+    assert(fmt(1e6, 10) == "1000000");
+    assert(fmt(123456789.125, 10) == "123456789.125");
+    assert(fmt(-1e20, 10) == "-100000000000000000000");
+    assert(fmt(9007199254740993.0, 0) == "9007199254740992");
+    assert(fmt(1e40, 10) == "1e+40");
+
+    assert(fmt(std::numeric_limits<double>::quiet_NaN(), 10) == "null");
+    assert(fmt(std::numeric_limits<double>::infinity(), 10) == "null");
+  }
+
+  // ___________________________________________________________________________
+  // same output as printf for random values
+  {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> latLng(-180, 180);
+    std::uniform_real_distribution<double> large(-1e7, 1e7);
+
+    for (int prec = 0; prec <= 15; prec++) {
+      for (size_t i = 0; i < 10000; i++) {
+        double d = i % 2 ? latLng(rng) : large(rng);
+        assert(fmt(d, prec) == printfFmt(d, prec));
+      }
+    }
+  }
+}
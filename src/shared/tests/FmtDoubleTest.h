@@ -0,0 +1,12 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#ifndef SHARED_TEST_FMTDOUBLETEST_H_
+#define SHARED_TEST_FMTDOUBLETEST_H_
+
+class FmtDoubleTest {
+  public:
+    void run();
+};
+
+#endif
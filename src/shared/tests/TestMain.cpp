@@ -1,6 +1,7 @@
 // Copyright 2016
 // Author: Patrick Brosi
 
+#include "shared/tests/FmtDoubleTest.h"
 #include "shared/tests/ILPSolverTest.h"
 
 #include "util/Misc.h"
@@ -9,7 +10,9 @@
 int main(int argc, char** argv) {
   UNUSED(argc);
   UNUSED(argv);
+  FmtDoubleTest fdt;
   ILPSolverTest gs;
 
+  fdt.run();
   gs.run();
 }
@@ -5,20 +5,165 @@
 #include <stdio.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "shared/linegraph/LineGraph.h"
+#include "shared/output/GeoGraphJsonWriter.h"
 #include "topo/config/ConfigReader.h"
 #include "topo/config/TopoConfig.h"
+#include "topo/incremental/CompCache.h"
 #include "topo/mapconstructor/MapConstructor.h"
 #include "topo/restr/RestrInferrer.h"
+#include "topo/sched/MemBudget.h"
 #include "topo/statinserter/StatInserter.h"
-#include "util/geo/output/GeoGraphJsonOutput.h"
+#include "util/Misc.h"
 #include "util/log/Log.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#define omp_get_num_procs() 1
+#endif
+
+// per-component statistics
+struct CompStats {
+  size_t iters = 0;
+  double constrT = 0;
+  double restrT = 0;
+  double stationT = 0;
+  topo::CollapseTimes collapseT;
+  size_t maxMergedEdgs = 0;
+  size_t totMergedEdgs = 0;
+  size_t totSupportGraphEdgs = 0;
+  size_t numNdsAfter = 0;
+  size_t numEdgsAfter = 0;
+  size_t numStationsAfter = 0;
+  double lenAfter = 0;
+  size_t numConExc = 0;
+};
+
+// _____________________________________________________________________________
+void processComp(LineGraph* tg, const topo::config::TopoConfig& cfg,
+                 CompStats* stats) {
+  topo::restr::RestrInferrer ri(&cfg, tg);
+  topo::MapConstructor mc(&cfg, tg);
+  topo::StatInserter si(&cfg, tg);
+
+  size_t statFr = mc.freeze();
+
+  si.init();
+
+  mc.averageNodePositions();
+
+  // does preserve existing turn restrictions
+  mc.removeNodeArtifacts(false);
+
+  mc.cleanUpGeoms();
+
+  // only remove the artifacts after the restriction inferrer has been
+  // initialized, as these operations do not guarantee that the restrictions
+  // are preserved!
+
+  ri.init();
+  size_t restrFr = mc.freeze();
+
+  mc.removeEdgeArtifacts();
+
+  T_START(construction);
+  if (cfg.collapseTileSize > 0) {
+    stats->iters += mc.collapseShrdSegsTiled(10, 50, cfg.segmentLength,
+                                             cfg.collapseTileSize);
+    stats->iters += mc.collapseShrdSegsTiled(
+        cfg.maxAggrDistance, 50, cfg.segmentLength, cfg.collapseTileSize);
+  } else {
+    stats->iters += mc.collapseShrdSegs(10, 50, cfg.segmentLength);
+    stats->iters +=
+        mc.collapseShrdSegs(cfg.maxAggrDistance, 50, cfg.segmentLength);
+  }
+  stats->constrT += T_STOP(construction);
+  stats->collapseT += mc.getCollapseTimes();
+
+  mc.removeNodeArtifacts(false);
+
+  if (cfg.outputStats) {
+    const auto& origEdgs = mc.freezeTrack(restrFr);
+    for (const auto& nd : tg->getNds()) {
+      for (const auto& e : nd->getAdjList()) {
+        if (e->getFrom() != nd) continue;
+        size_t cur = origEdgs.at(e).size();
+        if (cur > stats->maxMergedEdgs) stats->maxMergedEdgs = cur;
+        stats->totMergedEdgs += cur;
+        stats->totSupportGraphEdgs++;
+      }
+    }
+  }
+
+  mc.reconstructIntersections();
+
+  // infer restrictions
+  T_START(restrInf);
+  if (!cfg.noInferRestrs) ri.infer(mc.freezeTrack(restrFr));
+  stats->restrT += T_STOP(restrInf);
+
+  // insert stations
+  T_START(stationIns);
+  si.insertStations(mc.freezeTrack(statFr));
+  stats->stationT += T_STOP(stationIns);
+
+  // remove orphan lines, which may be introduced by another station
+  // placement
+  mc.removeOrphanLines();
+
+  mc.removeNodeArtifacts(true);
+
+  mc.reconstructIntersections();
+
+  // remove orphan lines again
+  mc.removeOrphanLines();
+
+  if (cfg.outputStats) {
+    for (const auto& nd : tg->getNds()) {
+      stats->numNdsAfter++;
+      if (nd->pl().stops().size()) stats->numStationsAfter++;
+      for (const auto& e : nd->getAdjList()) {
+        if (e->getFrom() != nd) continue;
+        stats->lenAfter += e->pl().getPolyline().getLength();
+        stats->numEdgsAfter++;
+      }
+    }
+  }
+
+  stats->numConExc += tg->numConnExcs();
+
+  if (cfg.smooth > 0) tg->smooth(cfg.smooth);
+}
+
+// _____________________________________________________________________________
+void printResults(const std::vector<LineGraph*>& resultGraphs,
+                  const std::vector<std::string>& resultHashes,
+                  const std::vector<std::string>& reusedHashes,
+                  const topo::CompCache& cache,
+                  shared::output::GeoGraphJsonWriter* out) {
+  for (size_t i = 0; i < resultGraphs.size(); i++) {
+    if (resultHashes[i].empty()) {
+      out->printLatLng(*resultGraphs[i]);
+    } else {
+      out->printLatLng(*resultGraphs[i],
+                       {{topo::COMP_HASH_KEY, resultHashes[i]}});
+    }
+  }
+
+  for (const auto& h : reusedHashes) {
+    for (const auto& feat : *cache.get(h)) out->printRaw(feat);
+  }
+}
+
 // _____________________________________________________________________________
 int main(int argc, char** argv) {
   // disable output buffering for standard output
@@ -33,6 +178,7 @@ int main(int argc, char** argv) {
   double constrT = 0;
   double restrT = 0;
   double stationT = 0;
+  topo::CollapseTimes collapseT;
 
   shared::linegraph::LineGraph lg;
   // read config
@@ -73,6 +219,18 @@ int main(int argc, char** argv) {
           restrT = stats.at("time_restr_inf").get<double>();
         if (stats.count("time_station_insert"))
           stationT = stats.at("time_station_insert").get<double>();
+        if (stats.count("time_const_collapse"))
+          collapseT.collapse = stats.at("time_const_collapse").get<double>();
+        if (stats.count("time_const_soft_cleanup"))
+          collapseT.softCleanup =
+              stats.at("time_const_soft_cleanup").get<double>();
+        if (stats.count("time_const_re_collapse"))
+          collapseT.reCollapse =
+              stats.at("time_const_re_collapse").get<double>();
+        if (stats.count("time_const_artifacts"))
+          collapseT.artifacts = stats.at("time_const_artifacts").get<double>();
+        if (stats.count("time_const_smooth"))
+          collapseT.smooth = stats.at("time_const_smooth").get<double>();
         if (stats.count("max_merged_edgs"))
           maxMergedEdgs = stats.at("max_merged_edgs").get<size_t>();
         if (stats.count("tot_merged_edgs"))
@@ -108,97 +266,99 @@ int main(int argc, char** argv) {
                           << " components (including single-node components)";
 
   std::vector<LineGraph*> resultGraphs;
-
-  size_t compI = 0;
-
-  // TODO: parallelize this (would increase memory usage significantly)?
-  for (auto& tg : graphs) {
-    LOGTO(DEBUG, std::cerr) << "@ Component" << compI++ << " components";
-
-    topo::restr::RestrInferrer ri(&cfg, &tg);
-    topo::MapConstructor mc(&cfg, &tg);
-    topo::StatInserter si(&cfg, &tg);
-
-    size_t statFr = mc.freeze();
-
-    si.init();
-
-    mc.averageNodePositions();
-
-    // does preserve existing turn restrictions
-    mc.removeNodeArtifacts(false);
-
-    mc.cleanUpGeoms();
-
-    // only remove the artifacts after the restriction inferrer has been
-    // initialized, as these operations do not guarantee that the restrictions
-    // are preserved!
-
-    ri.init();
-    size_t restrFr = mc.freeze();
-
-    mc.removeEdgeArtifacts();
-
-    T_START(construction);
-    iters += mc.collapseShrdSegs(10, 50, cfg.segmentLength);
-    iters += mc.collapseShrdSegs(cfg.maxAggrDistance, 50, cfg.segmentLength);
-    constrT += T_STOP(construction);
-
-    mc.removeNodeArtifacts(false);
-
-    if (cfg.outputStats) {
-      const auto& origEdgs = mc.freezeTrack(restrFr);
-      for (const auto& nd : tg.getNds()) {
-        for (const auto& e : nd->getAdjList()) {
-          if (e->getFrom() != nd) continue;
-          size_t cur = origEdgs.at(e).size();
-          if (cur > maxMergedEdgs) maxMergedEdgs = cur;
-          totMergedEdgs += cur;
-          totSupportGraphEdgs++;
-        }
-      }
+  std::vector<std::string> resultHashes;
+
+  // hashes of unchanged components taken from the previous output
+  std::vector<std::string> reusedHashes;
+
+  topo::CompCache cache;
+  if (!cfg.incrementalFrom.empty()) {
+    LOGTO(DEBUG, std::cerr) << "Reading previous output "
+                            << cfg.incrementalFrom << "...";
+    std::ifstream f(cfg.incrementalFrom);
+    if (!f.good()) {
+      LOG(ERROR) << "Could not open " << cfg.incrementalFrom;
+      exit(1);
     }
+    cache.read(&f);
+    LOGTO(DEBUG, std::cerr) << "Found " << cache.size()
+                            << " cached components";
+  }
 
-    mc.reconstructIntersections();
-
-    // infer restrictions
-    T_START(restrInf);
-    if (!cfg.noInferRestrs) ri.infer(mc.freezeTrack(restrFr));
-    restrT += T_STOP(restrInf);
-
-    // insert stations
-    T_START(stationIns);
-    si.insertStations(mc.freezeTrack(statFr));
-    stationT += T_STOP(stationIns);
-
-    // remove orphan lines, which may be introduced by another station
-    // placement
-    mc.removeOrphanLines();
-
-    mc.removeNodeArtifacts(true);
-
-    mc.reconstructIntersections();
+  std::vector<std::string> hashes(graphs.size());
+  std::vector<size_t> todo;
 
-    // remove orphan lines again
-    mc.removeOrphanLines();
+  for (size_t i = 0; i < graphs.size(); i++) {
+    if (cfg.writeCompHashes) hashes[i] = topo::compHash(graphs[i], cfg);
 
-    if (cfg.outputStats) {
-      for (const auto& nd : tg.getNds()) {
-        numNdsAfter++;
-        if (nd->pl().stops().size()) numStationsAfter++;
-        for (const auto& e : nd->getAdjList()) {
-          if (e->getFrom() != nd) continue;
-          lenAfter += e->pl().getPolyline().getLength();
-          numEdgsAfter++;
-        }
-      }
+    if (cache.get(hashes[i]) &&
+        std::find(reusedHashes.begin(), reusedHashes.end(), hashes[i]) ==
+            reusedHashes.end()) {
+      LOGTO(DEBUG, std::cerr) << "Component " << i
+                              << " unchanged, reusing previous output";
+      reusedHashes.push_back(hashes[i]);
+      continue;
     }
 
-    numConExc += tg.numConnExcs();
+    todo.push_back(i);
+  }
 
-    if (cfg.smooth > 0) tg.smooth(cfg.smooth);
+  std::vector<size_t> memEst(graphs.size(), 0);
+  for (auto i : todo)
+    memEst[i] = topo::sched::memEstimate(graphs[i], cfg.segmentLength);
+
+  // process the largest components first for a better load balance
+  std::stable_sort(todo.begin(), todo.end(), [&](size_t a, size_t b) {
+    return memEst[a] > memEst[b];
+  });
+
+  size_t numThreads = cfg.numThreads ? cfg.numThreads : omp_get_num_procs();
+  size_t memBudget = cfg.compMemBudget * 1024 * 1024;
+  if (memBudget == 0) memBudget = topo::sched::physMem() / 2;
+  if (memBudget == 0) memBudget = std::numeric_limits<size_t>::max();
+
+  LOGTO(DEBUG, std::cerr) << "Processing " << todo.size()
+                          << " components with " << numThreads
+                          << " threads, memory budget "
+                          << util::readableSize(memBudget);
+
+  topo::sched::MemBudget budget(memBudget);
+
+  // per-component stats, only merged after all components are done to
+  // keep the result independent of the scheduling
+  std::vector<CompStats> compStats(graphs.size());
+
+  // with a single component, keep the threads for the tiled collapse
+#pragma omp parallel for schedule(dynamic, 1) num_threads(numThreads) \
+    if (todo.size() > 1)
+  for (size_t j = 0; j < todo.size(); j++) {
+    size_t i = todo[j];
+    budget.acquire(memEst[i]);
+    LOGTO(DEBUG, std::cerr) << "@ Component " << i;
+    processComp(&graphs[i], cfg, &compStats[i]);
+    budget.release(memEst[i]);
+  }
 
-    resultGraphs.push_back(&tg);
+  std::sort(todo.begin(), todo.end());
+
+  for (auto i : todo) {
+    const auto& cs = compStats[i];
+    iters += cs.iters;
+    constrT += cs.constrT;
+    restrT += cs.restrT;
+    stationT += cs.stationT;
+    collapseT += cs.collapseT;
+    maxMergedEdgs = std::max(maxMergedEdgs, cs.maxMergedEdgs);
+    totMergedEdgs += cs.totMergedEdgs;
+    totSupportGraphEdgs += cs.totSupportGraphEdgs;
+    numNdsAfter += cs.numNdsAfter;
+    numEdgsAfter += cs.numEdgsAfter;
+    numStationsAfter += cs.numStationsAfter;
+    lenAfter += cs.lenAfter;
+    numConExc += cs.numConExc;
+
+    resultGraphs.push_back(&graphs[i]);
+    resultHashes.push_back(hashes[i]);
   }
 
   int numComps = 0;
@@ -208,8 +368,6 @@ int main(int argc, char** argv) {
   for (auto& tg : resultGraphs) {
     if (tg->getNds().size() == 0) continue;
     if (cfg.writeComponents || !cfg.componentsPath.empty()) {
-      util::geo::output::GeoGraphJsonOutput out;
-
       size_t locOffset = offset;
       const auto& graphs = tg->distConnectedComponents(
           cfg.connectedCompDist, cfg.writeComponents, &offset);
@@ -221,13 +379,13 @@ int main(int argc, char** argv) {
         f.open(cfg.componentsPath + "/component-" +
                std::to_string(locOffset + comp) + ".json");
 
-        out.printLatLng(graphs[comp], f);
+        shared::output::GeoGraphJsonWriter out(&f, cfg.outputPrecision);
+        out.printLatLng(graphs[comp]);
       }
     }
   }
 
   // output
-  util::geo::output::GeoGraphJsonOutput gout;
   if (cfg.outputStats) {
     util::json::Dict jsonStats = {
         {"statistics",
@@ -243,6 +401,11 @@ int main(int argc, char** argv) {
              {"time_const", constrT},
              {"time_restr_inf", restrT},
              {"time_station_insert", stationT},
+             {"time_const_collapse", collapseT.collapse},
+             {"time_const_soft_cleanup", collapseT.softCleanup},
+             {"time_const_re_collapse", collapseT.reCollapse},
+             {"time_const_artifacts", collapseT.artifacts},
+             {"time_const_smooth", collapseT.smooth},
              {"len_before", lenBef},
              {"num_restrs", numConExc},
              {"avg_merged_edgs", (static_cast<double>(totMergedEdgs) /
@@ -251,18 +414,16 @@ int main(int argc, char** argv) {
              {"len_after", lenAfter},
              {"tot_merged_edgs", totMergedEdgs},
              {"tot_support_graph_edgs", totSupportGraphEdgs},
+             {"num_components_reused", reusedHashes.size()},
          }}};
 
-    util::geo::output::GeoJsonOutput out(std::cout, jsonStats);
-    for (auto gg : resultGraphs) {
-      gout.printLatLng(*gg, &out);
-    }
+    shared::output::GeoGraphJsonWriter out(&std::cout, cfg.outputPrecision,
+                                           jsonStats);
+    printResults(resultGraphs, resultHashes, reusedHashes, cache, &out);
     out.flush();
   } else {
-    util::geo::output::GeoJsonOutput out(std::cout);
-    for (auto gg : resultGraphs) {
-      gout.printLatLng(*gg, &out);
-    }
+    shared::output::GeoGraphJsonWriter out(&std::cout, cfg.outputPrecision);
+    printResults(resultGraphs, resultHashes, reusedHashes, cache, &out);
     out.flush();
   }
 
@@ -67,7 +67,29 @@ void ConfigReader::help(const char* bin) const {
             << std::setw(40) << "  --smooth (=0)"
             << "smooth output graph edge geometries\n"
             << std::setw(40) << "  --aggr-stats"
-            << "aggregate stats with existing from input\n";
+            << "aggregate stats with existing from input\n"
+            << std::setw(40) << "  --write-comp-hashes"
+            << "write input component hash to output features\n"
+            << std::setw(40) << "  --incremental-from arg"
+            << "previous output (written with --write-comp-hashes),\n"
+            << std::setw(40) << " "
+            << "  unchanged components are copied from it\n"
+            << std::setw(40) << "  --threads arg (=0)"
+            << "number of components processed in parallel, 0 for\n"
+            << std::setw(40) << " "
+            << "  number of processors\n"
+            << std::setw(40) << "  --comp-mem-budget arg (=0)"
+            << "memory budget (MB) for parallel components, 0 for\n"
+            << std::setw(40) << " "
+            << "  half of the physical memory\n"
+            << std::setw(40) << "  --collapse-tile-size arg (=0)"
+            << "collapse tiles of this size (in pseudometers) in\n"
+            << std::setw(40) << " "
+            << "  parallel before merging them, 0 to disable\n"
+            << std::setw(40) << "  --precision arg (=-1)"
+            << "decimal places of output coordinates, -1 for\n"
+            << std::setw(40) << " "
+            << "  default formatting\n";
 }
 
 // _____________________________________________________________________________
@@ -91,6 +113,12 @@ void ConfigReader::read(TopoConfig* cfg, int argc, char** argv) const {
       {"smooth", required_argument, 0, 11},
       {"turn-restr-full-turn-angle", required_argument, 0, 12},
       {"aggr-stats", no_argument, 0, 13},
+      {"precision", required_argument, 0, 14},
+      {"write-comp-hashes", no_argument, 0, 15},
+      {"incremental-from", required_argument, 0, 16},
+      {"threads", required_argument, 0, 17},
+      {"comp-mem-budget", required_argument, 0, 18},
+      {"collapse-tile-size", required_argument, 0, 19},
       {0, 0, 0, 0}};
 
   double turnRestrDiff = -1;
@@ -146,6 +174,25 @@ void ConfigReader::read(TopoConfig* cfg, int argc, char** argv) const {
       case 13:
         cfg->aggregateStats = true;
         break;
+      case 14:
+        cfg->outputPrecision = atoi(optarg);
+        break;
+      case 15:
+        cfg->writeCompHashes = true;
+        break;
+      case 16:
+        cfg->incrementalFrom = optarg;
+        cfg->writeCompHashes = true;
+        break;
+      case 17:
+        cfg->numThreads = atoi(optarg);
+        break;
+      case 18:
+        cfg->compMemBudget = atoi(optarg);
+        break;
+      case 19:
+        cfg->collapseTileSize = atof(optarg);
+        break;
       case ':':
         std::cerr << argv[optind - 1];
         std::cerr << " requires an argument" << std::endl;
@@ -22,9 +22,15 @@ struct TopoConfig {
   bool writeComponents = false;
   bool randomColors = false;
   bool aggregateStats = false;
+  bool writeCompHashes = false;
   double connectedCompDist = 10000;
   double smooth = 0;
+  int outputPrecision = -1;
+  size_t numThreads = 0;
+  size_t compMemBudget = 0;
+  double collapseTileSize = 0;
   std::string componentsPath = "";
+  std::string incrementalFrom = "";
 };
 
 }  // namespace config
@@ -0,0 +1,204 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include "3rdparty/json.hpp"
+#include "topo/incremental/CompCache.h"
+
+using shared::linegraph::LineEdge;
+using shared::linegraph::LineNode;
+using topo::CompCache;
+
+namespace {
+
+// _____________________________________________________________________________
+// FNV-1a, we need a hash which is stable across builds and platforms
+class Hasher {
+ public:
+  Hasher() : _h(14695981039346656037ULL) {}
+
+  void add(const void* data, size_t len) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < len; i++) {
+      _h ^= p[i];
+      _h *= 1099511628211ULL;
+    }
+  }
+
+  void add(double d) { add(&d, sizeof(d)); }
+  void add(uint64_t i) { add(&i, sizeof(i)); }
+  void add(const std::string& s) {
+    add(static_cast<uint64_t>(s.size()));
+    add(s.data(), s.size());
+  }
+  void add(const util::geo::DPoint& p) {
+    add(p.getX());
+    add(p.getY());
+  }
+
+  uint64_t get() const { return _h; }
+
+ private:
+  uint64_t _h;
+};
+
+// _____________________________________________________________________________
+uint64_t ndHash(const LineNode* nd) {
+  Hasher h;
+  h.add(*nd->pl().getGeom());
+
+  for (const auto& s : nd->pl().stops()) {
+    h.add(s.id);
+    h.add(s.name);
+    h.add(s.pos);
+  }
+
+  std::vector<const std::string*> notServed;
+  for (auto l : nd->pl().getLinesNotServed()) notServed.push_back(&l->id());
+  std::sort(notServed.begin(), notServed.end(),
+            [](const std::string* a, const std::string* b) { return *a < *b; });
+  for (auto l : notServed) h.add(*l);
+
+  // turn restrictions, identified by the positions of the nodes they lead
+  // from and to
+  std::vector<uint64_t> excs;
+  for (const auto& ro : nd->pl().getConnExc()) {
+    for (const auto& exFr : ro.second) {
+      for (const auto* exTo : exFr.second) {
+        Hasher eh;
+        eh.add(ro.first->id());
+        eh.add(*exFr.first->getOtherNd(nd)->pl().getGeom());
+        eh.add(*exTo->getOtherNd(nd)->pl().getGeom());
+        excs.push_back(eh.get());
+      }
+    }
+  }
+  std::sort(excs.begin(), excs.end());
+  for (auto e : excs) h.add(e);
+
+  return h.get();
+}
+
+// _____________________________________________________________________________
+uint64_t edgHash(const LineEdge* e) {
+  Hasher h;
+  h.add(*e->getFrom()->pl().getGeom());
+  h.add(*e->getTo()->pl().getGeom());
+  for (const auto& p : *e->pl().getGeom()) h.add(p);
+
+  std::vector<uint64_t> lines;
+  for (const auto& lo : e->pl().getLines()) {
+    Hasher lh;
+    lh.add(lo.line->id());
+    lh.add(lo.line->label());
+    lh.add(lo.line->color());
+    uint64_t dir = lo.direction == 0 ? 0 : lo.direction == e->getTo() ? 1 : 2;
+    lh.add(dir);
+    lines.push_back(lh.get());
+  }
+  std::sort(lines.begin(), lines.end());
+  for (auto l : lines) h.add(l);
+
+  return h.get();
+}
+
+// _____________________________________________________________________________
+void rewriteId(nlohmann::json* val,
+               std::unordered_map<std::string, std::string>* ids,
+               const std::string& prefix) {
+  if (!val->is_string()) return;
+  const std::string old = val->get<std::string>();
+  auto i = ids->find(old);
+  if (i == ids->end()) {
+    i = ids->insert({old, prefix + ":" + std::to_string(ids->size())}).first;
+  }
+  *val = i->second;
+}
+
+}  // namespace
+
+// _____________________________________________________________________________
+std::string topo::compHash(const LineGraph& g, const TopoConfig& cfg) {
+  std::vector<uint64_t> hashes;
+
+  for (const auto nd : g.getNds()) {
+    hashes.push_back(ndHash(nd));
+    for (const auto e : nd->getAdjList()) {
+      if (e->getFrom() != nd) continue;
+      hashes.push_back(edgHash(e));
+    }
+  }
+
+  std::sort(hashes.begin(), hashes.end());
+
+  Hasher h;
+  h.add(cfg.maxAggrDistance);
+  h.add(cfg.maxLengthDev);
+  h.add(cfg.maxTurnRestrCheckDist);
+  h.add(cfg.turnInferFullTurnPen);
+  h.add(cfg.fullTurnAngle);
+  h.add(cfg.segmentLength);
+  h.add(static_cast<uint64_t>(cfg.noInferRestrs));
+  h.add(cfg.smooth);
+
+  for (auto v : hashes) h.add(v);
+
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx",
+           static_cast<unsigned long long>(h.get()));
+  return buf;
+}
+
+// _____________________________________________________________________________
+void CompCache::read(std::istream* s) {
+  nlohmann::json j;
+  (*s) >> j;
+
+  if (!j.count("features") || !j["features"].is_array()) return;
+
+  std::unordered_map<std::string, std::unordered_map<std::string, std::string>>
+      ids;
+
+  for (auto& feat : j["features"]) {
+    if (!feat.count("properties")) continue;
+    auto& props = feat["properties"];
+    if (!props.count(COMP_HASH_KEY) || !props[COMP_HASH_KEY].is_string())
+      continue;
+
+    const std::string h = props[COMP_HASH_KEY].get<std::string>();
+    auto& compIds = ids[h];
+
+    // node and edge ids are only unique within a single topo run, make them
+    // unique by binding them to the component hash
+    for (const auto& key : {"id", "from", "to"}) {
+      if (props.count(key)) rewriteId(&props[key], &compIds, h);
+    }
+
+    if (props.count("excluded_conn") && props["excluded_conn"].is_array()) {
+      for (auto& exc : props["excluded_conn"]) {
+        if (exc.count("node_from")) rewriteId(&exc["node_from"], &compIds, h);
+        if (exc.count("node_to")) rewriteId(&exc["node_to"], &compIds, h);
+      }
+    }
+
+    if (props.count("lines") && props["lines"].is_array()) {
+      for (auto& line : props["lines"]) {
+        if (line.count("direction"))
+          rewriteId(&line["direction"], &compIds, h);
+      }
+    }
+
+    _feats[h].push_back(feat.dump());
+  }
+}
+
+// _____________________________________________________________________________
+const std::vector<std::string>* CompCache::get(const std::string& h) const {
+  auto i = _feats.find(h);
+  if (i == _feats.end()) return 0;
+  return &i->second;
+}
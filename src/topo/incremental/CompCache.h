@@ -0,0 +1,47 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef TOPO_INCREMENTAL_COMPCACHE_H_
+#define TOPO_INCREMENTAL_COMPCACHE_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "shared/linegraph/LineGraph.h"
+#include "topo/config/TopoConfig.h"
+
+using shared::linegraph::LineGraph;
+using topo::config::TopoConfig;
+
+namespace topo {
+
+// feature property holding the input hash of the component a feature was
+// constructed from
+static const std::string COMP_HASH_KEY = "topo_comp_hash";
+
+// Hash of an input component, covering its geometry, lines, stations,
+// turn restrictions and the config parameters that influence its output.
+// Independent of node and edge iteration order.
+std::string compHash(const LineGraph& g, const TopoConfig& cfg);
+
+// Caches the output features of previously constructed components, keyed by
+// their input component hash.
+class CompCache {
+ public:
+  // read previous topo output, only features carrying a component hash are
+  // kept
+  void read(std::istream* s);
+
+  // returns the serialized features of component hash h, 0 if not cached
+  const std::vector<std::string>* get(const std::string& h) const;
+
+  size_t size() const { return _feats.size(); }
+
+ private:
+  std::unordered_map<std::string, std::vector<std::string>> _feats;
+};
+
+}  // namespace topo
+
+#endif  // TOPO_INCREMENTAL_COMPCACHE_H_
@@ -4,15 +4,20 @@
 
 #include <cassert>
 #include <climits>
+#include <cmath>
+#include <memory>
+#include <unordered_set>
 
 #include "shared/linegraph/LineGraph.h"
 #include "topo/mapconstructor/MapConstructor.h"
 #include "util/geo/Geo.h"
 #include "util/geo/Grid.h"
 #include "util/geo/output/GeoGraphJsonOutput.h"
+#include "util/Misc.h"
 #include "util/log/Log.h"
 
 using topo::MapConstructor;
+using topo::OrigEdgsView;
 using topo::ShrdSegWrap;
 using topo::config::TopoConfig;
 
@@ -111,13 +116,13 @@ LineNode* MapConstructor::ndCollapseCand(
   if (ndMin) {
     ndMin->pl().setGeom(util::geo::centroid(
         util::geo::LineSegment<double>(*ndMin->pl().getGeom(), point)));
-    geoIdx.remove(ndMin);
     ret = ndMin;
+    geoIdx.move(ret, *ret->pl().getGeom());
   } else {
     ret = g->addNd(point);
+    geoIdx.add(*ret->pl().getGeom(), ret);
   }
 
-  geoIdx.add(*ret->pl().getGeom(), ret);
   return ret;
 }
 
@@ -197,17 +202,42 @@ int MapConstructor::collapseShrdSegs(double dCut) {
 // _____________________________________________________________________________
 int MapConstructor::collapseShrdSegs(double dCut, size_t MAX_ITERS,
                                      double SEGL) {
+  // scratch containers are kept across iterations so their buffers are only
+  // allocated once. Nodes and edges of tgNew are still allocated one by one
+  // by util::graph, which offers no hook for pooled allocation.
+  std::unordered_map<LineNode*, LineNode*> imgNds;
+  std::set<LineNode*> imgNdsSet;
+  std::vector<std::pair<double, LineEdge*>> sortedEdges;
+  std::vector<LineNode*> affectedNodes;
+  std::vector<LineNode*> nds;
+
+  // cells sized to the query radius, a query touches at most 3x3 cells
+  NodeGeoIdx geoIdx(dCut);
+
+  // total edge length of _g, carried over from the previous iteration
+  double LEN_OLD = 0;
+  for (const auto& nd : _g->getNds()) {
+    for (const auto& e : nd->getAdjList()) {
+      if (e->getFrom() != nd) continue;
+      LEN_OLD += e->pl().getPolyline().getLength();
+    }
+  }
+
   size_t ITER = 0;
   for (; ITER < MAX_ITERS; ITER++) {
+    T_START(collapse);
     shared::linegraph::LineGraph tgNew;
 
-    // new grid per iteration
-    NodeGeoIdx geoIdx;
+    // empty grid per iteration, the cell buffers are reused
+    geoIdx.clear();
 
-    std::unordered_map<LineNode*, LineNode*> imgNds;
-    std::set<LineNode*> imgNdsSet;
+    imgNds.clear();
+    imgNdsSet.clear();
+    sortedEdges.clear();
+
+    imgNds.reserve(_g->getNds().size());
+    sortedEdges.reserve(_g->getNds().size());
 
-    std::vector<std::pair<double, LineEdge*>> sortedEdges;
     for (auto n : _g->getNds()) {
       for (auto e : n->getAdjList()) {
         if (e->getFrom() != n) continue;
@@ -225,7 +255,7 @@ int MapConstructor::collapseShrdSegs(double dCut, size_t MAX_ITERS,
       std::set<LineNode*> myNds;
 
       size_t i = 0;
-      std::vector<LineNode*> affectedNodes;
+      affectedNodes.clear();
       LineNode* front = 0;
       LineNode* back = e->getTo();
 
@@ -284,7 +314,7 @@ int MapConstructor::collapseShrdSegs(double dCut, size_t MAX_ITERS,
           if (!newE) {
             newE = tgNew.addEdg(last, cur);
 
-            for (const auto& oe : _origEdgs) assert(oe.count(newE) == 0);
+            assert(_origEdgs.count(newE) == 0);
           }
 
           combContEdgs(newE, e);
@@ -309,7 +339,7 @@ int MapConstructor::collapseShrdSegs(double dCut, size_t MAX_ITERS,
         if (!newE) {
           newE = tgNew.addEdg(imgNds[e->getFrom()], front);
 
-          for (const auto& oe : _origEdgs) assert(oe.count(newE) == 0);
+          assert(_origEdgs.count(newE) == 0);
         }
 
         combContEdgs(newE, e);
@@ -323,7 +353,7 @@ int MapConstructor::collapseShrdSegs(double dCut, size_t MAX_ITERS,
         if (!newE) {
           newE = tgNew.addEdg(last, imgNds[e->getTo()]);
 
-          for (const auto& oe : _origEdgs) assert(oe.count(newE) == 0);
+          assert(_origEdgs.count(newE) == 0);
         }
 
         combContEdgs(newE, e);
@@ -362,10 +392,12 @@ int MapConstructor::collapseShrdSegs(double dCut, size_t MAX_ITERS,
       }
     }
 
+    _collapseT.collapse += T_STOP(collapse);
+
     // soft cleanup
-    std::vector<LineNode*> ndsA;
-    ndsA.insert(ndsA.begin(), tgNew.getNds().begin(), tgNew.getNds().end());
-    for (auto from : ndsA) {
+    T_START(softCleanup);
+    nds.assign(tgNew.getNds().begin(), tgNew.getNds().end());
+    for (auto from : nds) {
       for (auto e : from->getAdjList()) {
         if (e->getFrom() != from) continue;
         auto to = e->getTo();
@@ -384,9 +416,15 @@ int MapConstructor::collapseShrdSegs(double dCut, size_t MAX_ITERS,
       }
     }
 
+    // from here on, record which edges get a new geometry
+    _dirty.clear();
+    _trackDirty = true;
+
+    _collapseT.softCleanup += T_STOP(softCleanup);
+
     // re-collapse
-    std::vector<LineNode*> nds;
-    nds.insert(nds.begin(), tgNew.getNds().begin(), tgNew.getNds().end());
+    T_START(reCollapse);
+    nds.assign(tgNew.getNds().begin(), tgNew.getNds().end());
 
     for (auto n : nds) {
       if (n->getDeg() != 2) continue;
@@ -416,13 +454,15 @@ int MapConstructor::collapseShrdSegs(double dCut, size_t MAX_ITERS,
       combineEdges(n->getAdjList().front(), n->getAdjList().back(), n, &tgNew);
     }
 
+    _collapseT.reCollapse += T_STOP(reCollapse);
+
     // remove edge artifacts as long as possible, because an artifact removal
     // might introduce another artifact if we fold edges
+    T_START(artifacts);
     bool found;
     do {
       found = false;
-      nds.clear();
-      nds.insert(nds.begin(), tgNew.getNds().begin(), tgNew.getNds().end());
+      nds.assign(tgNew.getNds().begin(), tgNew.getNds().end());
       std::set<const LineNode*> skip;
 
       for (auto from : nds) {
@@ -478,9 +518,11 @@ int MapConstructor::collapseShrdSegs(double dCut, size_t MAX_ITERS,
       }
     } while (found);
 
+    _collapseT.artifacts += T_STOP(artifacts);
+
     // re-collapse again because we might have introduced deg 2 nodes above
-    nds.clear();
-    nds.insert(nds.begin(), tgNew.getNds().begin(), tgNew.getNds().end());
+    T_START(reCollapse2);
+    nds.assign(tgNew.getNds().begin(), tgNew.getNds().end());
 
     for (auto n : nds) {
       if (n->getDeg() == 2 &&
@@ -499,35 +541,42 @@ int MapConstructor::collapseShrdSegs(double dCut, size_t MAX_ITERS,
       }
     }
 
-    // smoothen a bit
+    _collapseT.reCollapse += T_STOP(reCollapse2);
+
+    // smoothen a bit, and measure the new length on the way
+    T_START(smooth);
+    double LEN_NEW = 0;
     for (auto n : tgNew.getNds()) {
       for (auto e : n->getAdjList()) {
         if (e->getFrom() != n) continue;
         auto& pl = e->pl().getPolyline();
-        pl.smoothenOutliers(50);
-        pl.simplify(1);
-        pl = PolyLine<double>(util::geo::densify(pl.getLine(), 5));
-        pl.applyChaikinSmooth(1);
-        pl.simplify(1);
+
+        // all other edges still carry the straight geometry written after
+        // the soft cleanup, their length is a single segment
+        if (isDirty(e)) {
+          pl.smoothenOutliers(50);
+          pl.simplify(1);
+          pl = PolyLine<double>(util::geo::densify(pl.getLine(), 5));
+          pl.applyChaikinSmooth(1);
+          pl.simplify(1);
+        }
+
+        LEN_NEW += pl.getLength();
       }
     }
 
+    _trackDirty = false;
+    _dirty.clear();
+
+    _collapseT.smooth += T_STOP(smooth);
+
     // convergence criteria
     double THRESHOLD = 0.002;
 
-    double LEN_OLD = 0;
-    double LEN_NEW = 0;
-    for (const auto& nd : _g->getNds()) {
-      for (const auto& e : nd->getAdjList()) {
-        if (e->getFrom() != nd) continue;
-        LEN_OLD += e->pl().getPolyline().getLength();
-      }
-    }
-
-    for (const auto& nd : tgNew.getNds()) {
-      for (const auto& e : nd->getAdjList()) {
-        if (e->getFrom() != nd) continue;
-        LEN_NEW += e->pl().getPolyline().getLength();
+    // the edges of the old graph are gone, drop their provenance
+    for (auto n : _g->getNds()) {
+      for (auto e : n->getAdjList()) {
+        if (e->getFrom() == n) delOrigEdgsFor(e);
       }
     }
 
@@ -536,11 +585,296 @@ int MapConstructor::collapseShrdSegs(double dCut, size_t MAX_ITERS,
     LOGTO(DEBUG, std::cerr)
         << "iter " << ITER << ", distance gap: " << (1 - LEN_NEW / LEN_OLD);
     if (fabs(1 - LEN_NEW / LEN_OLD) < THRESHOLD) break;
+
+    LEN_OLD = LEN_NEW;
   }
 
   return ITER + 1;
 }
 
+// _____________________________________________________________________________
+int MapConstructor::collapseShrdSegsTiled(double dCut, size_t MAX_ITERS,
+                                          double SEGL, double tileSize) {
+  _tileStats = TileStats();
+
+  // an edge is only collapsed inside its tile if it is farther away than this
+  // from the inner tile borders, it can then never be merged with an edge
+  // owned by another tile
+  double halo = std::max(dCut, _cfg->maxAggrDistance);
+
+  const auto& box = bbox();
+  const auto& ll = box.getLowerLeft();
+  double w = box.getUpperRight().getX() - ll.getX();
+  double h = box.getUpperRight().getY() - ll.getY();
+
+  if (tileSize <= 2 * halo || (w <= tileSize && h <= tileSize))
+    return collapseShrdSegs(dCut, MAX_ITERS, SEGL);
+
+  size_t tilesX = std::max(1.0, std::ceil(w / tileSize));
+  size_t tilesY = std::max(1.0, std::ceil(h / tileSize));
+  size_t numTiles = tilesX * tilesY;
+
+  // assign edges to tiles
+  std::unordered_map<const LineEdge*, size_t> edgTile;
+  for (auto n : _g->getNds()) {
+    for (auto e : n->getAdjList()) {
+      if (e->getFrom() != n) continue;
+      auto eBox = util::geo::getBoundingBox(*e->pl().getGeom());
+      eBox = extendBox(*e->getFrom()->pl().getGeom(), eBox);
+      eBox = extendBox(*e->getTo()->pl().getGeom(), eBox);
+
+      size_t tx = std::min<size_t>(
+          tilesX - 1, (eBox.getLowerLeft().getX() - ll.getX()) / tileSize);
+      size_t ty = std::min<size_t>(
+          tilesY - 1, (eBox.getLowerLeft().getY() - ll.getY()) / tileSize);
+
+      double tMinX = ll.getX() + tx * tileSize;
+      double tMinY = ll.getY() + ty * tileSize;
+
+      // no halo is needed at the outer border of the graph
+      if ((tx == 0 || eBox.getLowerLeft().getX() >= tMinX + halo) &&
+          (ty == 0 || eBox.getLowerLeft().getY() >= tMinY + halo) &&
+          (tx == tilesX - 1 ||
+           eBox.getUpperRight().getX() <= tMinX + tileSize - halo) &&
+          (ty == tilesY - 1 ||
+           eBox.getUpperRight().getY() <= tMinY + tileSize - halo)) {
+        edgTile[e] = ty * tilesX + tx;
+      }
+    }
+  }
+
+  _tileStats.tileEdgs = edgTile.size();
+
+  std::unordered_set<const LineEdge*> unowned;
+  std::vector<bool> tileOk;
+  size_t iters = collapseGrps(edgTile, numTiles, dCut, MAX_ITERS, SEGL, halo,
+                              &unowned, &tileOk);
+
+  if (unowned.empty()) return iters;
+
+  // the seams are the edges which were not collapsed inside a tile, and all
+  // edges near them. Everything else is already collapsed and frozen
+  shared::linegraph::EdgeGrid seamIdx;
+  for (auto e : unowned) {
+    seamIdx.add(*e->pl().getGeom(), const_cast<LineEdge*>(e));
+  }
+
+  std::unordered_map<const LineEdge*, size_t> edgSeam;
+  for (auto n : _g->getNds()) {
+    for (auto e : n->getAdjList()) {
+      if (e->getFrom() != n) continue;
+      if (!unowned.count(e)) {
+        std::set<LineEdge*> near;
+        seamIdx.get(*e->pl().getGeom(), halo, &near);
+        if (near.empty()) {
+          _tileStats.frozenEdgs++;
+          continue;
+        }
+      }
+      edgSeam[e] = 0;
+    }
+  }
+
+  _tileStats.seamEdgs = edgSeam.size();
+
+  std::vector<bool> seamOk;
+  iters += collapseGrps(edgSeam, 1, dCut, MAX_ITERS, SEGL, halo, 0, &seamOk);
+
+  if (seamOk[0]) return iters;
+
+  // the seam result could not be stitched back, fall back to collapsing the
+  // whole graph
+  _tileStats.seamFallback = true;
+  return iters + collapseShrdSegs(dCut, MAX_ITERS, SEGL);
+}
+
+// _____________________________________________________________________________
+size_t MapConstructor::collapseGrps(
+    const std::unordered_map<const LineEdge*, size_t>& edgGrp, size_t numGrps,
+    double dCut, size_t MAX_ITERS, double SEGL, double halo,
+    std::unordered_set<const LineEdge*>* kept, std::vector<bool>* grpOk) {
+  // copy the edges of each group into a separate graph. Nodes with grouped
+  // and other adjacent edges are anchors, they are later mapped to their
+  // image in the collapsed group graph
+  std::vector<LineGraph> grpGraphs(numGrps);
+  std::vector<std::unordered_map<const LineEdge*, const LineEdge*>> grpToOrig(
+      numGrps);
+  std::vector<std::vector<const LineNode*>> anchors(numGrps);
+
+  for (auto n : _g->getNds()) {
+    size_t grp = numGrps;
+    bool anchor = false;
+    for (auto e : n->getAdjList()) {
+      auto it = edgGrp.find(e);
+      if (it == edgGrp.end()) {
+        anchor = true;
+      } else {
+        grp = it->second;
+      }
+    }
+    if (grp < numGrps && anchor) anchors[grp].push_back(n);
+  }
+
+  std::unordered_map<const LineNode*, LineNode*> grpNds;
+  for (auto n : _g->getNds()) {
+    for (auto e : n->getAdjList()) {
+      if (e->getFrom() != n) continue;
+      auto it = edgGrp.find(e);
+      if (it == edgGrp.end()) continue;
+      auto& tg = grpGraphs[it->second];
+
+      for (auto nd : {e->getFrom(), e->getTo()}) {
+        if (!grpNds.count(nd)) grpNds[nd] = tg.addNd(*nd->pl().getGeom());
+      }
+
+      auto fr = grpNds[e->getFrom()];
+      auto to = grpNds[e->getTo()];
+
+      auto newE = tg.addEdg(fr, to, e->pl());
+      LineGraph::nodeRpl(newE, e->getFrom(), fr);
+      LineGraph::nodeRpl(newE, e->getTo(), to);
+      grpToOrig[it->second][newE] = e;
+    }
+  }
+
+  // collapse groups in parallel, the group constructors are kept to look up
+  // the provenance of the group edges below
+  std::vector<std::unique_ptr<MapConstructor>> grpMcs(numGrps);
+  std::vector<size_t> grpFrs(numGrps, 0);
+  std::vector<size_t> grpIters(numGrps, 0);
+  std::vector<CollapseTimes> grpTimes(numGrps);
+
+#pragma omp parallel for schedule(dynamic, 1)
+  for (size_t t = 0; t < numGrps; t++) {
+    if (grpGraphs[t].getNds().size() == 0) continue;
+    grpMcs[t].reset(new MapConstructor(_cfg, &grpGraphs[t]));
+    grpFrs[t] = grpMcs[t]->freeze();
+    grpIters[t] = grpMcs[t]->collapseShrdSegs(dCut, MAX_ITERS, SEGL);
+    grpTimes[t] = grpMcs[t]->getCollapseTimes();
+  }
+
+  for (const auto& t : grpTimes) _collapseT += t;
+
+  // find the images of the anchor nodes, if an anchor has no image near
+  // its original position, the group result is dropped
+  auto& ok = *grpOk;
+  ok.assign(numGrps, true);
+  std::unordered_map<const LineNode*, LineNode*> anchorImgs;
+
+  for (size_t t = 0; t < numGrps; t++) {
+    if (anchors[t].empty()) continue;
+
+    std::vector<std::pair<DPoint, LineNode*>> nds;
+    for (auto n : grpGraphs[t].getNds()) {
+      if (n->getDeg()) nds.push_back({*n->pl().getGeom(), n});
+    }
+
+    NodeGeoIdx geoIdx(halo);
+    geoIdx.load(nds);
+
+    std::vector<std::pair<const LineNode*, LineNode*>> imgs;
+    for (auto a : anchors[t]) {
+      std::vector<LineNode*> neighbors;
+      geoIdx.get(*a->pl().getGeom(), halo, &neighbors);
+
+      LineNode* img = 0;
+      double dBest = std::numeric_limits<double>::infinity();
+      for (auto cand : neighbors) {
+        double d = util::geo::dist(*a->pl().getGeom(), *cand->pl().getGeom());
+        if (d < dBest) {
+          dBest = d;
+          img = cand;
+        }
+      }
+
+      if (!img) {
+        ok[t] = false;
+        break;
+      }
+      imgs.push_back({a, img});
+    }
+
+    if (ok[t]) anchorImgs.insert(imgs.begin(), imgs.end());
+  }
+
+  // stitch group results and the other edges into a new graph
+  shared::linegraph::LineGraph tgNew;
+  std::unordered_map<const LineNode*, LineNode*> imgNds;
+
+  for (const auto& img : anchorImgs) {
+    if (!imgNds.count(img.second))
+      imgNds[img.second] = tgNew.addNd(*img.second->pl().getGeom());
+    imgNds[img.first] = imgNds[img.second];
+  }
+
+  auto getImg = [&](const LineNode* n) -> LineNode* {
+    auto it = imgNds.find(n);
+    if (it != imgNds.end()) return it->second;
+    return imgNds[n] = tgNew.addNd(*n->pl().getGeom());
+  };
+
+  size_t maxIters = 0;
+
+  for (size_t t = 0; t < numGrps; t++) {
+    if (!ok[t] || !grpMcs[t]) continue;
+    maxIters = std::max(maxIters, grpIters[t]);
+
+    const auto& grpOrigEdgs = grpMcs[t]->freezeTrack(grpFrs[t]);
+
+    for (auto n : grpGraphs[t].getNds()) {
+      for (auto e : n->getAdjList()) {
+        if (e->getFrom() != n) continue;
+        auto fr = getImg(e->getFrom());
+        auto to = getImg(e->getTo());
+
+        auto newE = tgNew.addEdg(fr, to, e->pl());
+        LineGraph::nodeRpl(newE, e->getFrom(), fr);
+        LineGraph::nodeRpl(newE, e->getTo(), to);
+
+        for (auto grpOrig : grpOrigEdgs.at(e)) {
+          combContEdgs(newE, grpToOrig[t].at(grpOrig));
+        }
+      }
+    }
+  }
+
+  for (auto n : _g->getNds()) {
+    for (auto e : n->getAdjList()) {
+      if (e->getFrom() != n) continue;
+      auto it = edgGrp.find(e);
+      if (it != edgGrp.end() && ok[it->second]) continue;
+
+      auto fr = getImg(e->getFrom());
+      auto to = getImg(e->getTo());
+
+      // both ends collapsed into the same node
+      if (fr == to) continue;
+
+      auto newE = tgNew.getEdg(fr, to);
+      if (newE) {
+        mergeLines(newE, e, fr, to);
+      } else {
+        newE = tgNew.addEdg(fr, to, e->pl());
+        LineGraph::nodeRpl(newE, e->getFrom(), fr);
+        LineGraph::nodeRpl(newE, e->getTo(), to);
+      }
+
+      combContEdgs(newE, e);
+      if (kept) kept->insert(newE);
+    }
+  }
+
+  for (auto n : _g->getNds()) {
+    for (auto e : n->getAdjList()) {
+      if (e->getFrom() == n) delOrigEdgsFor(e);
+    }
+  }
+
+  *_g = std::move(tgNew);
+
+  return maxIters;
+}
+
 // _____________________________________________________________________________
 void MapConstructor::averageNodePositions() {
   for (auto n : _g->getNds()) {
@@ -693,6 +1027,8 @@ bool MapConstructor::combineEdges(LineEdge* a, LineEdge* b, LineNode* n,
   assert(newEdge != a);
   assert(newEdge != b);
 
+  markDirty(newEdge);
+
   combContEdgs(newEdge, a);
   combContEdgs(newEdge, b);
 
@@ -716,25 +1052,66 @@ bool MapConstructor::combineEdges(LineEdge* a, LineEdge* b, LineNode* n,
 
 // _____________________________________________________________________________
 size_t MapConstructor::freeze() {
-  _origEdgs.push_back(OrigEdgs());
+  size_t epoch = _numEpochs++;
+
   for (auto nd : _g->getNds()) {
     for (auto* edg : nd->getAdjList()) {
       if (edg->getFrom() != nd) continue;
-      _origEdgs.back()[edg].insert(edg);
+      auto leaf = std::make_shared<OrigEdgNd>();
+      leaf->orig = edg;
+      leaf->epoch = epoch;
+      leaf->epochs = 1ULL << std::min<size_t>(epoch, 63);
+      addOrigEdgNd(&_origEdgs[edg], leaf);
     }
   }
 
-  return _origEdgs.size() - 1;
+  return epoch;
+}
+
+// _____________________________________________________________________________
+OrigEdgsView MapConstructor::freezeTrack(size_t i) const {
+  return OrigEdgsView(&_origEdgs, i);
+}
+
+// _____________________________________________________________________________
+void MapConstructor::addOrigEdgNd(std::shared_ptr<OrigEdgNd>* nd,
+                                  const std::shared_ptr<OrigEdgNd>& child) {
+  if (!*nd) {
+    *nd = std::make_shared<OrigEdgNd>();
+  } else if (nd->use_count() > 1) {
+    // referenced from elsewhere, don't modify
+    auto wrap = std::make_shared<OrigEdgNd>();
+    wrap->epochs = (*nd)->epochs;
+    wrap->children.push_back(*nd);
+    *nd = wrap;
+  }
+
+  if (!child) return;
+  (*nd)->epochs |= child->epochs;
+  (*nd)->children.push_back(child);
 }
 
 // _____________________________________________________________________________
 void MapConstructor::combContEdgs(const LineEdge* a, const LineEdge* b) {
-  for (auto& oe : _origEdgs) oe[a].insert(oe[b].begin(), oe[b].end());
+  if (!_numEpochs || a == b) return;
+  const auto& provB = _origEdgs[b];
+  addOrigEdgNd(&_origEdgs[a], provB);
 }
 
 // _____________________________________________________________________________
 void MapConstructor::delOrigEdgsFor(const LineEdge* a) {
-  for (auto& oe : _origEdgs) oe.erase(a);
+  _origEdgs.erase(a);
+  _dirty.erase(a);
+}
+
+// _____________________________________________________________________________
+void MapConstructor::markDirty(const LineEdge* e) {
+  if (_trackDirty) _dirty.insert(e);
+}
+
+// _____________________________________________________________________________
+bool MapConstructor::isDirty(const LineEdge* e) const {
+  return _dirty.count(e);
 }
 
 // _____________________________________________________________________________
@@ -770,13 +1147,17 @@ bool MapConstructor::combineNodes(LineNode* a, LineNode* b, LineGraph* g) {
       // add a new edge going from b to the non-b node
       newE = g->addEdg(b, oldE->getTo(), std::move(oldE->pl()));
 
-      for (const auto& oe : _origEdgs) assert(oe.count(newE) == 0);
+      assert(_origEdgs.count(newE) == 0);
+
+      // the geometry moves along
+      if (isDirty(oldE)) markDirty(newE);
 
       // update route dirs
       LineGraph::nodeRpl(newE, a, b);
     } else {
       // edge is already existing
       foldEdges(oldE, newE);
+      markDirty(newE);
 
       // update route dirs
       LineGraph::nodeRpl(newE, a, b);
@@ -798,13 +1179,17 @@ bool MapConstructor::combineNodes(LineNode* a, LineNode* b, LineGraph* g) {
     if (!newE) {
       newE = g->addEdg(oldE->getFrom(), b, std::move(oldE->pl()));
 
-      for (const auto& oe : _origEdgs) assert(oe.count(newE) == 0);
+      assert(_origEdgs.count(newE) == 0);
+
+      // the geometry moves along
+      if (isDirty(oldE)) markDirty(newE);
 
       // update route dirs
       LineGraph::nodeRpl(newE, a, b);
     } else {
       // edge is already existing
       foldEdges(oldE, newE);
+      markDirty(newE);
 
       // update route dirs
       LineGraph::nodeRpl(newE, a, b);
@@ -1122,8 +1507,8 @@ void MapConstructor::supportEdge(LineEdge* ex, LineGraph* g) {
   auto eA = g->addEdg(ex->getFrom(), supNd, ex->pl());
   auto eB = g->addEdg(supNd, ex->getTo(), ex->pl());
 
-  for (const auto& oe : _origEdgs) assert(oe.count(eB) == 0);
-  for (const auto& oe : _origEdgs) assert(oe.count(eA) == 0);
+  assert(_origEdgs.count(eB) == 0);
+  assert(_origEdgs.count(eA) == 0);
 
   assert(eA != ex);
   assert(eB != ex);
@@ -1137,6 +1522,11 @@ void MapConstructor::supportEdge(LineEdge* ex, LineGraph* g) {
   eA->pl().setGeom(plA);
   eB->pl().setGeom(plB);
 
+  if (isDirty(ex)) {
+    markDirty(eA);
+    markDirty(eB);
+  }
+
   g->delEdg(ex->getFrom(), ex->getTo());
   delOrigEdgsFor(ex);
 }
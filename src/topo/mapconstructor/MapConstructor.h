@@ -6,9 +6,14 @@
 #define TOPO_MAPCONSTRUCTOR_MAPCONSTRUCTOR_H_
 
 #include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include "shared/linegraph/LineGraph.h"
 #include "topo/config/TopoConfig.h"
+#include "topo/mapconstructor/NodeGrid.h"
+#include "topo/mapconstructor/OrigEdgs.h"
 #include "topo/restr/RestrGraph.h"
 #include "util/geo/Geo.h"
 #include "util/geo/Grid.h"
@@ -37,10 +42,7 @@ using shared::linegraph::LineNode;
 using shared::linegraph::LineNodePL;
 using shared::linegraph::Station;
 
-// typedef Grid<LineNode*, Point, double> NodeGeoIdx;
-typedef RTree<LineNode*, Point, double> NodeGeoIdx;
-
-typedef std::unordered_map<const LineEdge*, std::set<const LineEdge*>> OrigEdgs;
+typedef topo::NodeGrid<LineNode*> NodeGeoIdx;
 
 namespace topo {
 
@@ -66,6 +68,37 @@ struct ShrdSegWrap {
   SharedSegment<double> s;
 };
 
+// time spent in the phases of collapseShrdSegs, in ms
+struct CollapseTimes {
+  double collapse = 0;
+  double softCleanup = 0;
+  double reCollapse = 0;
+  double artifacts = 0;
+  double smooth = 0;
+
+  CollapseTimes& operator+=(const CollapseTimes& o) {
+    collapse += o.collapse;
+    softCleanup += o.softCleanup;
+    reCollapse += o.reCollapse;
+    artifacts += o.artifacts;
+    smooth += o.smooth;
+    return *this;
+  }
+};
+
+// edge counts of the phases of collapseShrdSegsTiled
+struct TileStats {
+  // edges collapsed inside the tiles
+  size_t tileEdgs = 0;
+
+  // edges handed to the seam pass, and edges left untouched by it
+  size_t seamEdgs = 0;
+  size_t frozenEdgs = 0;
+
+  // the seam pass result could not be used, the whole graph was collapsed
+  bool seamFallback = false;
+};
+
 class MapConstructor {
  public:
   MapConstructor(const TopoConfig* cfg, LineGraph* g);
@@ -74,17 +107,33 @@ class MapConstructor {
   int collapseShrdSegs(double dCut);
   int collapseShrdSegs(double dCut, size_t MAX_ITERS, double segmentLen);
 
+  // like collapseShrdSegs, but first collapse the interiors of square tiles
+  // of side length tileSize in parallel. The seams between tiles are then
+  // collapsed in a final pass which leaves the tile interiors untouched
+  int collapseShrdSegsTiled(double dCut, size_t MAX_ITERS, double segmentLen,
+                            double tileSize);
+
   void averageNodePositions();
   void removeEdgeArtifacts();
   void removeNodeArtifacts(bool keepStations);
 
   void reconstructIntersections();
 
+  // start tracking which edges of the current graph the edges resulting from
+  // later operations cover, returns the epoch id
   size_t freeze();
 
   bool cleanUpGeoms();
 
-  const OrigEdgs& freezeTrack(size_t i) const { return _origEdgs[i]; }
+  // the edges of freeze() epoch i each current edge covers, only valid until
+  // the graph is modified again
+  OrigEdgsView freezeTrack(size_t i) const;
+
+  // accumulated over all collapseShrdSegs calls
+  const CollapseTimes& getCollapseTimes() const { return _collapseT; }
+
+  // of the last collapseShrdSegsTiled call
+  const TileStats& getTileStats() const { return _tileStats; }
   void removeOrphanLines();
 
  private:
@@ -112,6 +161,8 @@ class MapConstructor {
   bool contractNodes();
 
   void combContEdgs(const LineEdge* a, const LineEdge* b);
+
+  // called before a is deleted, drops its provenance and dirty flag
   void delOrigEdgsFor(const LineEdge* a);
   void delOrigEdgsFor(const LineNode* a);
 
@@ -125,6 +176,21 @@ class MapConstructor {
                   LineNode* newTo);
   void supportEdge(LineEdge* ex, LineGraph* g);
 
+  // collapse the edges of each of the numGrps groups in edgGrp separately
+  // and in parallel, and stitch the results back into the graph. Edges
+  // without a group and the edges of groups whose result could not be
+  // stitched back are copied unchanged and written to kept, if given.
+  // Returns the maximum number of iterations over all groups
+  size_t collapseGrps(const std::unordered_map<const LineEdge*, size_t>& edgGrp,
+                      size_t numGrps, double dCut, size_t MAX_ITERS,
+                      double SEGL, double halo,
+                      std::unordered_set<const LineEdge*>* kept,
+                      std::vector<bool>* grpOk);
+
+  // mark e as changed since the last soft cleanup of collapseShrdSegs
+  void markDirty(const LineEdge* e);
+  bool isDirty(const LineEdge* e) const;
+
   PolyLine<double> geomAvg(const LineEdgePL& geomA, double startA, double endA,
                            const LineEdgePL& geomB, double startB, double endB);
 
@@ -136,7 +202,20 @@ class MapConstructor {
   std::set<LineEdgePair> _indEdgesPairs;
   std::map<LineEdgePair, size_t> _pEdges;
 
-  std::vector<OrigEdgs> _origEdgs;
+  // provenance of each current edge, shared across all freeze() epochs
+  OrigEdgNds _origEdgs;
+  size_t _numEpochs = 0;
+
+  static void addOrigEdgNd(std::shared_ptr<OrigEdgNd>* nd,
+                           const std::shared_ptr<OrigEdgNd>& child);
+
+  CollapseTimes _collapseT;
+  TileStats _tileStats;
+
+  // edges whose geometry changed since the last soft cleanup, only tracked
+  // while _trackDirty is set
+  std::unordered_set<const LineEdge*> _dirty;
+  bool _trackDirty = false;
 };
 
 }  // namespace topo
@@ -0,0 +1,145 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef TOPO_MAPCONSTRUCTOR_NODEGRID_H_
+#define TOPO_MAPCONSTRUCTOR_NODEGRID_H_
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "util/geo/Geo.h"
+
+namespace topo {
+
+// Uniform hash grid over point values, specialised for the move-heavy
+// workload of the shared segment collapsing: values can be relocated in
+// O(1), and the cell buffers are kept across clear() calls. The cell size
+// should be in the order of the query radius.
+template <typename V>
+class NodeGrid {
+ public:
+  explicit NodeGrid(double cellSize) : _cellSize(cellSize > 0 ? cellSize : 1) {}
+
+  // replace the current content with vals, bucketed in a single pass
+  void load(const std::vector<std::pair<util::geo::DPoint, V>>& vals) {
+    clear();
+    _idx.reserve(vals.size());
+    for (const auto& v : vals) add(v.first, v.second);
+  }
+
+  // add v at position p, if v is already contained, it is moved to p
+  void add(const util::geo::DPoint& p, V v) {
+    if (_idx.count(v)) {
+      move(v, p);
+      return;
+    }
+    insert(cellKey(p), p, v);
+  }
+
+  // remove v, no-op if v is not contained
+  void remove(V v) {
+    auto it = _idx.find(v);
+    if (it == _idx.end()) return;
+    auto loc = it->second;
+    _idx.erase(it);
+    erase(loc.first, loc.second);
+  }
+
+  // move v to position p
+  void move(V v, const util::geo::DPoint& p) {
+    auto it = _idx.find(v);
+    if (it == _idx.end()) {
+      insert(cellKey(p), p, v);
+      return;
+    }
+
+    uint64_t k = cellKey(p);
+    auto loc = it->second;
+
+    if (loc.first == k) {
+      // stays in the same cell, just update the position
+      _cells[k][loc.second].pos = p;
+      return;
+    }
+
+    _idx.erase(it);
+    erase(loc.first, loc.second);
+    insert(k, p, v);
+  }
+
+  // write all values whose position lies in the box of side length 2d
+  // centered at p into ret
+  void get(const util::geo::DPoint& p, double d, std::vector<V>* ret) const {
+    int64_t xFrom = cellCoord(p.getX() - d);
+    int64_t xTo = cellCoord(p.getX() + d);
+    int64_t yFrom = cellCoord(p.getY() - d);
+    int64_t yTo = cellCoord(p.getY() + d);
+
+    for (int64_t x = xFrom; x <= xTo; x++) {
+      for (int64_t y = yFrom; y <= yTo; y++) {
+        auto c = _cells.find(key(x, y));
+        if (c == _cells.end()) continue;
+        for (const auto& e : c->second) {
+          if (fabs(e.pos.getX() - p.getX()) > d) continue;
+          if (fabs(e.pos.getY() - p.getY()) > d) continue;
+          ret->push_back(e.val);
+        }
+      }
+    }
+  }
+
+  // remove all values, the cell buffers are kept
+  void clear() {
+    for (auto& c : _cells) c.second.clear();
+    _idx.clear();
+  }
+
+  size_t size() const { return _idx.size(); }
+
+ private:
+  struct Entry {
+    V val;
+    util::geo::DPoint pos;
+  };
+
+  double _cellSize;
+  std::unordered_map<uint64_t, std::vector<Entry>> _cells;
+
+  // cell key and slot of each value
+  std::unordered_map<V, std::pair<uint64_t, size_t>> _idx;
+
+  int64_t cellCoord(double c) const {
+    return static_cast<int64_t>(std::floor(c / _cellSize));
+  }
+
+  static uint64_t key(int64_t x, int64_t y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+           static_cast<uint32_t>(y);
+  }
+
+  uint64_t cellKey(const util::geo::DPoint& p) const {
+    return key(cellCoord(p.getX()), cellCoord(p.getY()));
+  }
+
+  void insert(uint64_t k, const util::geo::DPoint& p, V v) {
+    auto& cell = _cells[k];
+    _idx[v] = {k, cell.size()};
+    cell.push_back({v, p});
+  }
+
+  void erase(uint64_t k, size_t slot) {
+    auto& cell = _cells[k];
+    if (slot + 1 != cell.size()) {
+      cell[slot] = cell.back();
+      _idx[cell[slot].val].second = slot;
+    }
+    cell.pop_back();
+  }
+};
+
+}  // namespace topo
+
+#endif  // TOPO_MAPCONSTRUCTOR_NODEGRID_H_
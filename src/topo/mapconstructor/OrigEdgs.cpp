@@ -0,0 +1,49 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "topo/mapconstructor/OrigEdgs.h"
+
+using shared::linegraph::LineEdge;
+using topo::OrigEdgNd;
+using topo::OrigEdgsView;
+
+// _____________________________________________________________________________
+const std::set<const LineEdge*>& OrigEdgsView::at(const LineEdge* e) const {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _cache.find(e);
+    if (it != _cache.end()) return it->second;
+  }
+
+  // collected without holding the lock, the DAG is not modified while the
+  // view is in use
+  std::set<const LineEdge*> origs;
+  auto it = _nds->find(e);
+  if (it != _nds->end() && it->second) collect(it->second.get(), &origs);
+
+  // references to map elements stay valid on insertion
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _cache.emplace(e, std::move(origs)).first->second;
+}
+
+// _____________________________________________________________________________
+void OrigEdgsView::collect(const OrigEdgNd* nd,
+                           std::set<const LineEdge*>* ret) const {
+  uint64_t bit = 1ULL << std::min<size_t>(_epoch, 63);
+
+  std::unordered_set<const OrigEdgNd*> seen;
+  std::vector<const OrigEdgNd*> stack{nd};
+
+  while (!stack.empty()) {
+    auto cur = stack.back();
+    stack.pop_back();
+
+    if (!(cur->epochs & bit) || !seen.insert(cur).second) continue;
+    if (cur->orig && cur->epoch == _epoch) ret->insert(cur->orig);
+    for (const auto& c : cur->children) stack.push_back(c.get());
+  }
+}
@@ -0,0 +1,67 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef TOPO_MAPCONSTRUCTOR_ORIGEDGS_H_
+#define TOPO_MAPCONSTRUCTOR_ORIGEDGS_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+#include "shared/linegraph/LineGraph.h"
+
+namespace topo {
+
+// Node of the orig edge provenance DAG. Leaves are the edges present at a
+// freeze(), inner nodes collect the provenance of merged edges. Nodes
+// referenced from more than one place are never modified, so a merge only
+// adds a child instead of copying sets.
+struct OrigEdgNd {
+  // only set for leaves
+  const shared::linegraph::LineEdge* orig = 0;
+  size_t epoch = 0;
+
+  // epochs of all leaves below this node, epochs >= 63 share the last bit
+  uint64_t epochs = 0;
+
+  std::vector<std::shared_ptr<OrigEdgNd>> children;
+};
+
+typedef std::unordered_map<const shared::linegraph::LineEdge*,
+                           std::shared_ptr<OrigEdgNd>>
+    OrigEdgNds;
+
+// Read-only view on the edges of a freeze() epoch the current edges cover.
+// The covered edges of an edge are only collected from the provenance DAG
+// once they are first requested, this may happen concurrently. The view is
+// only valid as long as the DAG is not modified.
+class OrigEdgsView {
+ public:
+  OrigEdgsView(const OrigEdgNds* nds, size_t epoch)
+      : _nds(nds), _epoch(epoch) {}
+  OrigEdgsView(OrigEdgsView&& o)
+      : _nds(o._nds), _epoch(o._epoch), _cache(std::move(o._cache)) {}
+
+  // the covered edges of e, empty if e is not tracked
+  const std::set<const shared::linegraph::LineEdge*>& at(
+      const shared::linegraph::LineEdge* e) const;
+
+ private:
+  const OrigEdgNds* _nds;
+  size_t _epoch;
+
+  mutable std::mutex _mutex;
+  mutable std::unordered_map<const shared::linegraph::LineEdge*,
+                             std::set<const shared::linegraph::LineEdge*>>
+      _cache;
+
+  void collect(const OrigEdgNd* nd,
+               std::set<const shared::linegraph::LineEdge*>* ret) const;
+};
+
+}  // namespace topo
+
+#endif  // TOPO_MAPCONSTRUCTOR_ORIGEDGS_H_
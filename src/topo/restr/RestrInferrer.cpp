@@ -2,8 +2,15 @@
 // Chair of Algorithms and Data Structures.
 // Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "shared/linegraph/LineGraph.h"
 #include "topo/config/TopoConfig.h"
@@ -67,7 +74,7 @@ void RestrInferrer::init() {
 }
 
 // _____________________________________________________________________________
-size_t RestrInferrer::infer(const OrigEdgs& origEdgs) {
+size_t RestrInferrer::infer(const OrigEdgsView& origEdgs) {
   // delete all existing restrictions
 
   for (auto nd : _tg->getNds()) nd->pl().clearConnExc();
@@ -81,33 +88,19 @@ size_t RestrInferrer::infer(const OrigEdgs& origEdgs) {
 
   size_t ret = 0;
 
-  for (auto nd : _tg->getNds()) {
-    for (auto edg1 : nd->getAdjList()) {
-      // check every other edge
-      for (auto edg2 : nd->getAdjList()) {
-        if (edg1 == edg2) continue;
+  std::vector<LineNode*> nds(_tg->getNds().begin(), _tg->getNds().end());
 
-        for (auto ro1 : edg1->pl().getLines()) {
-          if (!edg2->pl().hasLine(ro1.line)) continue;
+  // the checks at each node only read the graphs, so they can run in
+  // parallel. Restrictions are written afterwards in node order.
+  std::vector<std::vector<InfRestr>> restrs(nds.size());
 
-          const auto& ro2 = edg2->pl().lineOcc(ro1.line);
+#pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < nds.size(); i++) inferAt(nds[i], &restrs[i]);
 
-          if (ro1.direction != 0 && ro2.direction != 0 &&
-              ro1.direction == ro2.direction)
-            continue;
-
-          if (ro1.direction != 0 && ro2.direction != 0 &&
-              edg1->getOtherNd(ro1.direction) ==
-                  edg2->getOtherNd(ro2.direction)) {
-            continue;
-          }
-
-          if (!check(ro1.line, edg1, edg2) && !check(ro1.line, edg2, edg1)) {
-            nd->pl().addConnExc(ro1.line, edg1, edg2);
-            ret++;
-          }
-        }
-      }
+  for (size_t i = 0; i < nds.size(); i++) {
+    for (const auto& restr : restrs[i]) {
+      nds[i]->pl().addConnExc(restr.line, restr.from, restr.to);
+      ret++;
     }
   }
 
@@ -147,7 +140,91 @@ size_t RestrInferrer::infer(const OrigEdgs& origEdgs) {
 }
 
 // _____________________________________________________________________________
-void RestrInferrer::addHndls(const OrigEdgs& origEdgs) {
+void RestrInferrer::inferAt(const LineNode* nd,
+                            std::vector<InfRestr>* restrs) const {
+  // restriction graph edges into the handles of each adjacent edge
+  std::map<const LineEdge*, std::set<RestrEdge*>> hndls;
+  for (auto edg : nd->getAdjList()) hndlEdgs(edg, nd, &hndls[edg]);
+
+  // connections (line, from, to) which occured in the original graph
+  std::set<std::tuple<const Line*, const LineEdge*, const LineEdge*>> conns;
+
+  // curdist + maxL is the inf. We do not have to check any further as we
+  // only accept a connection below if cost - curD < maxL <=> cost < curD +
+  // maxL, + epsilon to avoid integer rounding issues in the < comparison
+  double eps = 0.1;
+
+  // a single bounded search per line and source edge, settling the handles
+  // of all other adjacent edges carrying the line at once
+  for (auto edg1 : nd->getAdjList()) {
+    const auto& from = hndls[edg1];
+    if (from.empty()) continue;
+
+    for (const auto& lo : edg1->pl().getLines()) {
+      std::set<RestrEdge*> to;
+      double maxD = 0;
+
+      for (auto edg2 : nd->getAdjList()) {
+        if (edg1 == edg2 || !edg2->pl().hasLine(lo.line)) continue;
+        to.insert(hndls[edg2].begin(), hndls[edg2].end());
+        maxD = std::max(maxD, expLen(edg1, edg2));
+      }
+
+      if (to.empty()) continue;
+
+      CostFunc cFunc(lo.line, maxD + _cfg->maxLengthDev + eps,
+                     _cfg->turnInferFullTurnPen, _cfg->fullTurnAngle);
+
+      std::unordered_map<const RestrEdge*, double> costs;
+      reach(cFunc, from, to, &costs);
+
+      for (auto edg2 : nd->getAdjList()) {
+        if (edg1 == edg2 || !edg2->pl().hasLine(lo.line)) continue;
+
+        double cost = std::numeric_limits<double>::infinity();
+        for (auto e : hndls[edg2]) {
+          auto c = costs.find(e);
+          if (c != costs.end()) cost = std::min(cost, c->second);
+        }
+
+        if (cost - expLen(edg1, edg2) < _cfg->maxLengthDev) {
+          conns.insert(std::make_tuple(lo.line, edg1, edg2));
+        }
+      }
+    }
+  }
+
+  for (auto edg1 : nd->getAdjList()) {
+    // check every other edge
+    for (auto edg2 : nd->getAdjList()) {
+      if (edg1 == edg2) continue;
+
+      for (auto ro1 : edg1->pl().getLines()) {
+        if (!edg2->pl().hasLine(ro1.line)) continue;
+
+        const auto& ro2 = edg2->pl().lineOcc(ro1.line);
+
+        if (ro1.direction != 0 && ro2.direction != 0 &&
+            ro1.direction == ro2.direction)
+          continue;
+
+        if (ro1.direction != 0 && ro2.direction != 0 &&
+            edg1->getOtherNd(ro1.direction) ==
+                edg2->getOtherNd(ro2.direction)) {
+          continue;
+        }
+
+        if (!conns.count(std::make_tuple(ro1.line, edg1, edg2)) &&
+            !conns.count(std::make_tuple(ro1.line, edg2, edg1))) {
+          restrs->push_back({ro1.line, edg1, edg2});
+        }
+      }
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void RestrInferrer::addHndls(const OrigEdgsView& origEdgs) {
   std::map<RestrEdge*, HndlLst> handles;
 
   // collect the handles
@@ -228,7 +305,8 @@ void RestrInferrer::edgeRpl(RestrNode* n, const RestrEdge* oldE,
 }
 
 // _____________________________________________________________________________
-void RestrInferrer::addHndls(const LineEdge* e, const OrigEdgs& origEdgs,
+void RestrInferrer::addHndls(const LineEdge* e,
+                             const OrigEdgsView& origEdgs,
                              std::map<RestrEdge*, HndlLst>* handles) {
   AggrDistFunc aggrD(_cfg->maxAggrDistance);
 
@@ -260,7 +338,7 @@ void RestrInferrer::addHndls(const LineEdge* e, const OrigEdgs& origEdgs,
   b = _rg.addNd(hndlLB.back());
   _rg.addEdg(a, b, RestrEdgePL(PolyLine<double>(hndlLB)));
 
-  for (auto edg : origEdgs.find(e)->second) {
+  for (auto edg : origEdgs.at(e)) {
     auto origFr = const_cast<LineEdge*>(edg);
     const auto& edgs = _eMap.find(origFr)->second;
 
@@ -310,48 +388,68 @@ void RestrInferrer::addHndls(const LineEdge* e, const OrigEdgs& origEdgs,
 }
 
 // _____________________________________________________________________________
-bool RestrInferrer::check(const Line* r, const LineEdge* edg1,
-                          const LineEdge* edg2) const {
-  std::set<RestrEdge*> from, to;
-  auto shrdNd = shared::linegraph::LineGraph::sharedNode(edg1, edg2);
-
-  double curD = edg1->pl().getPolyline().getLength() * 0.33 +
-                edg2->pl().getPolyline().getLength() * 0.33;
-
-  if (shrdNd == edg1->getFrom()) {
-    if (_handlesA.count(edg1)) {
-      for (auto nd : _handlesA.find(edg1)->second) {
-        from.insert(nd->getAdjListIn().begin(), nd->getAdjListIn().end());
-      }
-    }
-  } else {
-    if (_handlesB.count(edg1)) {
-      for (auto nd : _handlesB.find(edg1)->second) {
-        from.insert(nd->getAdjListIn().begin(), nd->getAdjListIn().end());
-      }
-    }
+double RestrInferrer::expLen(const LineEdge* edg1, const LineEdge* edg2) {
+  return edg1->pl().getPolyline().getLength() * 0.33 +
+         edg2->pl().getPolyline().getLength() * 0.33;
+}
+
+// _____________________________________________________________________________
+void RestrInferrer::hndlEdgs(const LineEdge* e, const LineNode* nd,
+                             std::set<RestrEdge*>* ret) const {
+  const auto& hndls = nd == e->getFrom() ? _handlesA : _handlesB;
+  auto it = hndls.find(e);
+  if (it == hndls.end()) return;
+
+  for (auto hndlNd : it->second) {
+    ret->insert(hndlNd->getAdjListIn().begin(), hndlNd->getAdjListIn().end());
   }
+}
 
-  if (shrdNd == edg2->getFrom()) {
-    if (_handlesA.count(edg2)) {
-      for (auto nd : _handlesA.find(edg2)->second) {
-        to.insert(nd->getAdjListIn().begin(), nd->getAdjListIn().end());
-      }
-    }
-  } else {
-    if (_handlesB.count(edg2)) {
-      for (auto nd : _handlesB.find(edg2)->second) {
-        to.insert(nd->getAdjListIn().begin(), nd->getAdjListIn().end());
-      }
-    }
+// _____________________________________________________________________________
+void RestrInferrer::reach(
+    const CostFunc& cFunc, const std::set<RestrEdge*>& from,
+    const std::set<RestrEdge*>& to,
+    std::unordered_map<const RestrEdge*, double>* costs) const {
+  typedef std::pair<double, RestrEdge*> PQItem;
+  std::priority_queue<PQItem, std::vector<PQItem>, std::greater<PQItem>> pq;
+
+  std::unordered_map<const RestrEdge*, double> dist;
+  std::unordered_set<const RestrEdge*> settled;
+  size_t left = to.size();
+
+  for (auto e : from) {
+    double c = cFunc(0, 0, e);
+    if (c >= cFunc.inf()) continue;
+    dist[e] = c;
+    pq.push({c, e});
   }
 
-  // curdist + maxL is the inf. We do not have to check any further as we
-  // only return true below if cost - curD < maxL <=> cost < curD + maxL
-  // + epsilon to avoid integer rounding issues in the < comparison below
-  double eps = 0.1;
-  CostFunc cFunc(r, curD + _cfg->maxLengthDev + eps, _cfg->turnInferFullTurnPen,
-                 _cfg->fullTurnAngle);
+  while (!pq.empty() && left) {
+    auto cur = pq.top();
+    pq.pop();
+
+    if (!settled.insert(cur.second).second) continue;
 
-  return EDijkstra::shortestPath(from, to, cFunc) - curD < _cfg->maxLengthDev;
+    if (to.count(cur.second)) {
+      (*costs)[cur.second] = cur.first;
+      left--;
+    }
+
+    auto n = cur.second->getTo();
+    for (auto e : n->getAdjListOut()) {
+      if (settled.count(e)) continue;
+
+      double step = cFunc(cur.second, n, e);
+      if (step >= cFunc.inf()) continue;
+
+      double c = cur.first + step;
+      if (c >= cFunc.inf()) continue;
+
+      auto d = dist.find(e);
+      if (d != dist.end() && d->second <= c) continue;
+
+      dist[e] = c;
+      pq.push({c, e});
+    }
+  }
 }
@@ -10,6 +10,7 @@
 #include "shared/linegraph/Line.h"
 #include "shared/linegraph/LineGraph.h"
 #include "topo/config/TopoConfig.h"
+#include "topo/mapconstructor/OrigEdgs.h"
 #include "topo/restr/RestrGraph.h"
 #include "util/graph/EDijkstra.h"
 
@@ -29,7 +30,6 @@ using util::graph::EDijkstra;
 namespace topo {
 namespace restr {
 
-typedef std::unordered_map<const LineEdge*, std::set<const LineEdge*>> OrigEdgs;
 typedef std::pair<RestrNode*, double> Hndl;
 typedef std::vector<Hndl> HndlLst;
 
@@ -78,6 +78,13 @@ struct CostFunc : public EDijkstra::CostFunc<RestrNodePL, RestrEdgePL, double> {
   double _fullTurnAngle;
 };
 
+// a turn restriction found during inference, not yet written to the graph
+struct InfRestr {
+  const Line* line;
+  const LineEdge* from;
+  const LineEdge* to;
+};
+
 struct HndlCmp {
   bool operator()(const Hndl& a, const Hndl& b) const {
     return a.second < b.second;
@@ -89,7 +96,7 @@ class RestrInferrer {
   RestrInferrer(const TopoConfig* cfg, LineGraph* g);
 
   void init();
-  size_t infer(const OrigEdgs& origEdgs);
+  size_t infer(const OrigEdgsView& origEdgs);
 
  private:
   const TopoConfig* _cfg;
@@ -108,11 +115,26 @@ class RestrInferrer {
   // graph representation
   std::unordered_map<const LineNode*, RestrNode*> _nMap;
 
-  // check whether a connection ocurred in the original graph
-  bool check(const Line* r, const LineEdge* edg1, const LineEdge* edg2) const;
+  // collect the restriction graph edges leading into the handles of e next
+  // to node nd
+  void hndlEdgs(const LineEdge* e, const LineNode* nd,
+                std::set<RestrEdge*>* ret) const;
+
+  // bounded one-to-many search from the edges in from, writes the costs of
+  // all edges in to reached below cFunc.inf() into costs
+  void reach(const CostFunc& cFunc, const std::set<RestrEdge*>& from,
+             const std::set<RestrEdge*>& to,
+             std::unordered_map<const RestrEdge*, double>* costs) const;
+
+  // the length we expect a connection between edg1 and edg2 to have in the
+  // original graph
+  static double expLen(const LineEdge* edg1, const LineEdge* edg2);
+
+  // collect the turn restrictions at a single node, only reads the graphs
+  void inferAt(const LineNode* nd, std::vector<InfRestr>* restrs) const;
 
-  void addHndls(const OrigEdgs& origEdgs);
-  void addHndls(const LineEdge* e, const OrigEdgs& origEdgs,
+  void addHndls(const OrigEdgsView& origEdgs);
+  void addHndls(const LineEdge* e, const OrigEdgsView& origEdgs,
                 std::map<RestrEdge*, HndlLst>* handles);
 
   void edgeRpl(RestrNode* n, const RestrEdge* oldE, const RestrEdge* newE);
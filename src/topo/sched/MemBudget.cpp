@@ -0,0 +1,55 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <unistd.h>
+#include "topo/sched/MemBudget.h"
+
+using topo::sched::MemBudget;
+
+// approx. bytes per support graph sample point (node, edge, geometries,
+// orig edge sets and index entries)
+static const size_t BYTES_PER_SAMPLE = 1024;
+
+// _____________________________________________________________________________
+size_t topo::sched::memEstimate(const LineGraph& g, double segmentLength) {
+  double samples = 0;
+  for (const auto nd : g.getNds()) {
+    samples += 1;
+    for (const auto e : nd->getAdjList()) {
+      if (e->getFrom() != nd) continue;
+      samples += e->pl().getGeom()->size();
+      samples += (1 + e->pl().getLines().size()) *
+                 e->pl().getPolyline().getLength() / segmentLength;
+    }
+  }
+
+  return static_cast<size_t>(samples) * BYTES_PER_SAMPLE;
+}
+
+// _____________________________________________________________________________
+size_t topo::sched::physMem() {
+  long pages = sysconf(_SC_PHYS_PAGES);
+  long pageSize = sysconf(_SC_PAGE_SIZE);
+  if (pages < 0 || pageSize < 0) return 0;
+  return static_cast<size_t>(pages) * static_cast<size_t>(pageSize);
+}
+
+// _____________________________________________________________________________
+MemBudget::MemBudget(size_t budget) : _budget(budget), _used(0) {}
+
+// _____________________________________________________________________________
+void MemBudget::acquire(size_t size) {
+  std::unique_lock<std::mutex> lock(_m);
+  _cv.wait(lock, [&] { return _used == 0 || _used + size <= _budget; });
+  _used += size;
+}
+
+// _____________________________________________________________________________
+void MemBudget::release(size_t size) {
+  {
+    std::lock_guard<std::mutex> lock(_m);
+    _used -= size;
+  }
+  _cv.notify_all();
+}
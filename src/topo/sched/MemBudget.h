@@ -0,0 +1,45 @@
+// Copyright 2023, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef TOPO_SCHED_MEMBUDGET_H_
+#define TOPO_SCHED_MEMBUDGET_H_
+
+#include <condition_variable>
+#include <mutex>
+#include "shared/linegraph/LineGraph.h"
+
+using shared::linegraph::LineGraph;
+
+namespace topo {
+namespace sched {
+
+// Rough estimate of the peak memory (in bytes) needed to construct the map
+// of component g, dominated by the sample points of the support graph.
+size_t memEstimate(const LineGraph& g, double segmentLength);
+
+// Physical memory of this machine in bytes, 0 if unknown.
+size_t physMem();
+
+// Limits the summed memory estimates of components processed concurrently.
+class MemBudget {
+ public:
+  explicit MemBudget(size_t budget);
+
+  // Block until size fits into the remaining budget. A request larger than
+  // the full budget is granted as soon as nothing else is running.
+  void acquire(size_t size);
+  void release(size_t size);
+
+ private:
+  size_t _budget;
+  size_t _used;
+
+  std::mutex _m;
+  std::condition_variable _cv;
+};
+
+}  // namespace sched
+}  // namespace topo
+
+#endif  // TOPO_SCHED_MEMBUDGET_H_
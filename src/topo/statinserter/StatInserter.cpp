@@ -2,8 +2,10 @@
 // Chair of Algorithms and Data Structures.
 // Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
+#include <unordered_set>
 
 #include "shared/linegraph/LineGraph.h"
 #include "topo/statinserter/StatInserter.h"
@@ -13,6 +15,10 @@
 
 using namespace topo;
 
+// number of stations whose candidates are scored in parallel before they are
+// inserted
+const static size_t STAT_BATCH_SIZE = 4096;
+
 using topo::config::TopoConfig;
 
 using util::geo::Box;
@@ -107,17 +113,26 @@ void StatInserter::init() {
                           << " station clusters...";
 }
 
+// _____________________________________________________________________________
+const std::set<const LineEdge*>& StatInserter::covered(
+    const LineEdge* e, const OrigEdgsView& origEdgs) const {
+  auto it = _splitFrom.find(e);
+  if (it != _splitFrom.end()) return origEdgs.at(it->second);
+  return origEdgs.at(e);
+}
+
 // _____________________________________________________________________________
 StationOcc StatInserter::unserved(const std::vector<LineEdge*>& adj,
                                   const StationOcc& stationOcc,
-                                  const OrigEdgs& origEdgs) {
+                                  const OrigEdgsView& origEdgs) const {
   StationOcc ret{stationOcc.stations, {}, {}, stationOcc.geom};
   std::set<const LineEdge*> contained;
   std::set<const shared::linegraph::Line*> containedLines;
 
-  for (auto e : adj)
-    contained.insert(origEdgs.find(e)->second.begin(),
-                     origEdgs.find(e)->second.end());
+  for (auto e : adj) {
+    const auto& origs = covered(e, origEdgs);
+    contained.insert(origs.begin(), origs.end());
+  }
 
   for (auto e : adj) {
     for (auto lo : e->pl().getLines()) {
@@ -145,13 +160,14 @@ StationOcc StatInserter::unserved(const std::vector<LineEdge*>& adj,
 std::pair<size_t, size_t> StatInserter::served(
     const std::vector<LineEdge*>& adj, const std::set<const LineEdge*>& toServe,
     const std::set<const shared::linegraph::Line*>& linesToServe,
-    const OrigEdgs& origEdgs) {
+    const OrigEdgsView& origEdgs) const {
   std::set<const LineEdge*> contained;
   std::set<const shared::linegraph::Line*> containedLines;
 
-  for (auto e : adj)
-    contained.insert(origEdgs.find(e)->second.begin(),
-                     origEdgs.find(e)->second.end());
+  for (auto e : adj) {
+    const auto& origs = covered(e, origEdgs);
+    contained.insert(origs.begin(), origs.end());
+  }
 
   for (auto e : adj) {
     for (auto lo : e->pl().getLines()) {
@@ -191,7 +207,7 @@ std::set<const shared::linegraph::Line*> StatInserter::wronglyServedLines(
 }
 
 // _____________________________________________________________________________
-double StatInserter::candScore(const StationCand& c) {
+double StatInserter::candScore(const StationCand& c) const {
   double score = 0;
 
   score += c.dist;
@@ -218,9 +234,9 @@ double StatInserter::candScore(const StationCand& c) {
 }
 
 // _____________________________________________________________________________
-std::vector<StationCand> StatInserter::candidates(const StationOcc& occ,
-                                                  const EdgeGeoIdx& idx,
-                                                  const OrigEdgs& origEdgs) {
+std::vector<StationCand> StatInserter::candidates(
+    const StationOcc& occ, const EdgeGeoIdx& idx,
+    const OrigEdgsView& origEdgs) const {
   std::vector<StationCand> ret;
   std::set<LineEdge*> neighbors;
   idx.get(util::geo::pad(util::geo::getBoundingBox(occ.stations.front().pos),
@@ -292,114 +308,156 @@ std::vector<StationCand> StatInserter::candidates(const StationOcc& occ,
 }
 
 // _____________________________________________________________________________
-bool StatInserter::insertStations(const OrigEdgs& origEdgs) {
-  OrigEdgs modOrigEdgs = origEdgs;
+bool StatInserter::insertStations(const OrigEdgsView& origEdgs) {
   auto idx = geoIndex();
+  _splitFrom.clear();
 
   std::unordered_map<LineNode*, std::vector<std::pair<double, Station>>>
       newStats;
 
-  for (auto curOcc : _statClusters) {
-    LOGTO(DEBUG, std::cerr) << "Inserting " << curOcc.stations.front().name;
+  // candidates are first scored for a batch of stations in parallel. An
+  // insertion may split an edge, the candidates of a later station in the
+  // same batch are only re-scored if they reference such an edge, as only
+  // then can its candidates have changed
+  std::vector<std::vector<StationCand>> batchCands;
+  std::unordered_set<const LineEdge*> splitEdgs;
+
+  for (size_t batch = 0; batch < _statClusters.size();
+       batch += STAT_BATCH_SIZE) {
+    size_t batchEnd =
+        std::min(_statClusters.size(), batch + STAT_BATCH_SIZE);
+
+    batchCands.clear();
+    batchCands.resize(batchEnd - batch);
+    splitEdgs.clear();
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t j = batch; j < batchEnd; j++) {
+      batchCands[j - batch] = candidates(_statClusters[j], idx, origEdgs);
+    }
+
+    for (size_t j = batch; j < batchEnd; j++) {
+      auto curOcc = _statClusters[j];
+      LOGTO(DEBUG, std::cerr) << "Inserting " << curOcc.stations.front().name;
 
-    int MAX_INSERTS = 3;
-    int i = 0;
+      int MAX_INSERTS = 3;
+      int i = 0;
 
-    while (i++ < MAX_INSERTS) {
-      auto cands = candidates(curOcc, idx, modOrigEdgs);
+      while (i++ < MAX_INSERTS) {
+        std::vector<StationCand> cands;
 
-      if (cands.size() == 0) {
-        LOGTO(DEBUG, std::cerr) << "  (No insertion candidate found.)";
-        break;
-      }
+        if (i == 1) {
+          cands = std::move(batchCands[j - batch]);
+          bool stale = false;
+          for (const auto& cand : cands) {
+            if (cand.edg && splitEdgs.count(cand.edg)) {
+              stale = true;
+              break;
+            }
+          }
+          if (stale) cands = candidates(curOcc, idx, origEdgs);
+        } else {
+          cands = candidates(curOcc, idx, origEdgs);
+        }
 
-      auto curCan = cands.front();
+        if (cands.size() == 0) {
+          LOGTO(DEBUG, std::cerr) << "  (No insertion candidate found.)";
+          break;
+        }
 
-      if (curCan.truelyServ == 0 && curCan.truelyServedLines == 0) {
-        LOGTO(DEBUG, std::cerr) << "  (No insertion candidate found.)";
-        break;
-      }
+        auto curCan = cands.front();
 
-      if (curCan.edg) {
-        auto e = curCan.edg;
+        if (curCan.truelyServ == 0 && curCan.truelyServedLines == 0) {
+          LOGTO(DEBUG, std::cerr) << "  (No insertion candidate found.)";
+          break;
+        }
 
-        auto spl = split(e->pl(), e->getFrom(), e->getTo(), curCan.pos);
+        if (curCan.edg) {
+          auto e = curCan.edg;
 
-        auto nd =
-            shared::linegraph::LineGraph::sharedNode(spl.first, spl.second);
+          auto spl = split(e->pl(), e->getFrom(), e->getTo(), curCan.pos);
 
-        // ensure all lines served at this node
-        for (auto l : curOcc.lines) nd->pl().delLineNotServed(l);
+          auto nd =
+              shared::linegraph::LineGraph::sharedNode(spl.first, spl.second);
 
-        // collect all lines that have been previously served, if this is
-        // a station
-        std::set<const shared::linegraph::Line*> containedLines;
-        if (newStats[nd].size()) {
-          for (auto e : nd->getAdjList()) {
-            for (auto lo : e->pl().getLines()) {
-              if (nd->pl().lineServed(lo.line)) containedLines.insert(lo.line);
+          // ensure all lines served at this node
+          for (auto l : curOcc.lines) nd->pl().delLineNotServed(l);
+
+          // collect all lines that have been previously served, if this is
+          // a station
+          std::set<const shared::linegraph::Line*> containedLines;
+          if (newStats[nd].size()) {
+            for (auto e : nd->getAdjList()) {
+              for (auto lo : e->pl().getLines()) {
+                if (nd->pl().lineServed(lo.line))
+                  containedLines.insert(lo.line);
+              }
             }
           }
-        }
 
-        newStats[nd].push_back(
-            {curOcc.stations.size(), curOcc.stations.front()});
+          newStats[nd].push_back(
+              {curOcc.stations.size(), curOcc.stations.front()});
 
-        // delete wrongly served lines
-        const auto& wrong = wronglyServedLines(nd->getAdjList(), curOcc.lines);
-        for (auto line : wrong) {
-          if (!containedLines.count(line)) nd->pl().addLineNotServed(line);
-        }
+          // delete wrongly served lines
+          const auto& wrong =
+              wronglyServedLines(nd->getAdjList(), curOcc.lines);
+          for (auto line : wrong) {
+            if (!containedLines.count(line)) nd->pl().addLineNotServed(line);
+          }
 
-        idx.add(*spl.first->pl().getGeom(), spl.first);
-        idx.add(*spl.second->pl().getGeom(), spl.second);
+          idx.add(*spl.first->pl().getGeom(), spl.first);
+          idx.add(*spl.second->pl().getGeom(), spl.second);
 
-        // UPDATE ORIGEDGES
-        modOrigEdgs[spl.first] = modOrigEdgs[e];
-        modOrigEdgs[spl.second] = modOrigEdgs[e];
+          // UPDATE ORIGEDGES
+          auto splitFrom = _splitFrom.find(e);
+          auto orig = splitFrom == _splitFrom.end() ? e : splitFrom->second;
+          _splitFrom[spl.first] = orig;
+          _splitFrom[spl.second] = orig;
 
-        edgeRpl(e->getFrom(), e, spl.first);
-        edgeRpl(e->getTo(), e, spl.second);
+          edgeRpl(e->getFrom(), e, spl.first);
+          edgeRpl(e->getTo(), e, spl.second);
 
-        _g->delEdg(e->getFrom(), e->getTo());
-        idx.remove(e);
-      } else {
-        // ensure all lines served at this node
-        for (auto l : curOcc.lines) curCan.nd->pl().delLineNotServed(l);
-
-        // collect all lines that have been previously served, if this is
-        // a station
-        std::set<const shared::linegraph::Line*> containedLines;
-        if (newStats[curCan.nd].size()) {
-          for (auto e : curCan.nd->getAdjList()) {
-            for (auto lo : e->pl().getLines()) {
-              if (curCan.nd->pl().lineServed(lo.line))
-                containedLines.insert(lo.line);
+          _g->delEdg(e->getFrom(), e->getTo());
+          idx.remove(e);
+          splitEdgs.insert(e);
+        } else {
+          // ensure all lines served at this node
+          for (auto l : curOcc.lines) curCan.nd->pl().delLineNotServed(l);
+
+          // collect all lines that have been previously served, if this is
+          // a station
+          std::set<const shared::linegraph::Line*> containedLines;
+          if (newStats[curCan.nd].size()) {
+            for (auto e : curCan.nd->getAdjList()) {
+              for (auto lo : e->pl().getLines()) {
+                if (curCan.nd->pl().lineServed(lo.line))
+                  containedLines.insert(lo.line);
+              }
             }
           }
-        }
 
-        newStats[curCan.nd].push_back(
-            {curOcc.stations.size(), curOcc.stations.front()});
+          newStats[curCan.nd].push_back(
+              {curOcc.stations.size(), curOcc.stations.front()});
 
-        // delete wrongly served lines
-        const auto& wrong =
-            wronglyServedLines(curCan.nd->getAdjList(), curOcc.lines);
-        for (auto line : wrong) {
-          if (!containedLines.count(line))
-            curCan.nd->pl().addLineNotServed(line);
+          // delete wrongly served lines
+          const auto& wrong =
+              wronglyServedLines(curCan.nd->getAdjList(), curOcc.lines);
+          for (auto line : wrong) {
+            if (!containedLines.count(line))
+              curCan.nd->pl().addLineNotServed(line);
+          }
         }
-      }
 
-      if (curCan.unserved.edges.size() == 0 &&
-          curCan.unserved.lines.size() == 0)
-        break;
+        if (curCan.unserved.edges.size() == 0 &&
+            curCan.unserved.lines.size() == 0)
+          break;
 
-      LOGTO(DEBUG, std::cerr)
-          << "  inserting for remaining " << curCan.unserved.edges.size()
-          << " unserved edges and/or " << curCan.unserved.lines.size()
-          << " unserved lines...";
-      curOcc = curCan.unserved;
+        LOGTO(DEBUG, std::cerr)
+            << "  inserting for remaining " << curCan.unserved.edges.size()
+            << " unserved edges and/or " << curCan.unserved.lines.size()
+            << " unserved lines...";
+        curOcc = curCan.unserved;
+      }
     }
   }
 
@@ -10,6 +10,7 @@
 
 #include "shared/linegraph/LineGraph.h"
 #include "topo/config/TopoConfig.h"
+#include "topo/mapconstructor/OrigEdgs.h"
 #include "util/geo/Geo.h"
 #include "util/geo/Grid.h"
 #include "util/geo/PolyLine.h"
@@ -39,8 +40,6 @@ using shared::linegraph::Station;
 
 typedef RTree<LineEdge*, Line, double> EdgeGeoIdx;
 
-typedef std::unordered_map<const LineEdge*, std::set<const LineEdge*>> OrigEdgs;
-
 namespace topo {
 
 struct StationOcc {
@@ -74,33 +73,43 @@ class StatInserter {
   StatInserter(const TopoConfig* cfg, LineGraph* g);
 
   void init();
-  bool insertStations(const OrigEdgs& origEdgs);
+  bool insertStations(const OrigEdgsView& origEdgs);
 
  private:
   const config::TopoConfig* _cfg;
   LineGraph* _g;
 
+  // edges split by a station insertion, mapped to the edge in the orig edge
+  // view they were split from
+  std::unordered_map<const LineEdge*, const LineEdge*> _splitFrom;
+
+  // the orig edges e covers, also for edges resulting from splits
+  const std::set<const LineEdge*>& covered(
+      const LineEdge* e, const OrigEdgsView& origEdgs) const;
+
+  // only reads the graph, safe to call concurrently
   std::vector<StationCand> candidates(const StationOcc& occ,
                                       const EdgeGeoIdx& idx,
-                                      const OrigEdgs& origEdgs);
+                                      const OrigEdgsView& origEdgs) const;
 
   DBox bbox() const;
   EdgeGeoIdx geoIndex();
 
-  double candScore(const StationCand& c);
+  double candScore(const StationCand& c) const;
 
   std::pair<size_t, size_t> served(
       const std::vector<LineEdge*>& adj,
       const std::set<const LineEdge*>& toServe,
       const std::set<const shared::linegraph::Line*>& linesToServe,
-      const OrigEdgs& origEdgs);
+      const OrigEdgsView& origEdgs) const;
 
   std::set<const shared::linegraph::Line*> wronglyServedLines(
     const std::vector<LineEdge*>& adj,
     const std::set<const shared::linegraph::Line*>& linesToServe);
 
   StationOcc unserved(const std::vector<LineEdge*>& adj,
-                      const StationOcc& stationOcc, const OrigEdgs& origEdgs);
+                      const StationOcc& stationOcc,
+                      const OrigEdgsView& origEdgs) const;
 
   LineEdgePair split(LineEdgePL& a, LineNode* fr, LineNode* to, double p);
 
@@ -0,0 +1,104 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#include <cassert>
+#include <sstream>
+#include <string>
+
+#include "3rdparty/json.hpp"
+#include "shared/linegraph/LineGraph.h"
+#include "topo/config/TopoConfig.h"
+#include "topo/incremental/CompCache.h"
+#include "topo/tests/CompCacheTest.h"
+#include "util/Misc.h"
+
+// _____________________________________________________________________________
+void CompCacheTest::run() {
+  // ___________________________________________________________________________
+  {
+    topo::config::TopoConfig cfg;
+
+    shared::linegraph::Line l1("1", "1", "red");
+    shared::linegraph::Line l2("2", "2", "green");
+
+    shared::linegraph::LineGraph tgA;
+    auto a = tgA.addNd({{0.0, 0.0}});
+    auto b = tgA.addNd({{100.0, 0.0}});
+    auto c = tgA.addNd({{200.0, 0.0}});
+    auto ab = tgA.addEdg(a, b, {{{0.0, 0.0}, {100.0, 0.0}}});
+    auto bc = tgA.addEdg(b, c, {{{100.0, 0.0}, {200.0, 0.0}}});
+    ab->pl().addLine(&l1, 0);
+    bc->pl().addLine(&l1, 0);
+    bc->pl().addLine(&l2, c);
+
+    // same graph, built in a different order
+    shared::linegraph::LineGraph tgB;
+    auto c2 = tgB.addNd({{200.0, 0.0}});
+    auto b2 = tgB.addNd({{100.0, 0.0}});
+    auto a2 = tgB.addNd({{0.0, 0.0}});
+    auto bc2 = tgB.addEdg(b2, c2, {{{100.0, 0.0}, {200.0, 0.0}}});
+    auto ab2 = tgB.addEdg(a2, b2, {{{0.0, 0.0}, {100.0, 0.0}}});
+    bc2->pl().addLine(&l2, c2);
+    bc2->pl().addLine(&l1, 0);
+    ab2->pl().addLine(&l1, 0);
+
+    assert(topo::compHash(tgA, cfg) == topo::compHash(tgB, cfg));
+
+    // line direction changed
+    bc2->pl().delLine(&l2);
+    bc2->pl().addLine(&l2, b2);
+    assert(topo::compHash(tgA, cfg) != topo::compHash(tgB, cfg));
+
+    bc2->pl().delLine(&l2);
+    bc2->pl().addLine(&l2, c2);
+    assert(topo::compHash(tgA, cfg) == topo::compHash(tgB, cfg));
+
+    // station added
+    b2->pl().addStop(
+        shared::linegraph::Station("b", "b", *b2->pl().getGeom()));
+    assert(topo::compHash(tgA, cfg) != topo::compHash(tgB, cfg));
+
+    // config changed
+    topo::config::TopoConfig cfg2;
+    cfg2.maxAggrDistance = 20;
+    assert(topo::compHash(tgA, cfg) != topo::compHash(tgA, cfg2));
+  }
+
+  // ___________________________________________________________________________
+  {
+    std::stringstream ss;
+    ss << "{\"type\":\"FeatureCollection\",\"features\":["
+          "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\","
+          "\"coordinates\":[0,0]},\"properties\":{\"id\":\"n1\","
+          "\"topo_comp_hash\":\"abc\"}},"
+          "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\","
+          "\"coordinates\":[0,1]},\"properties\":{\"id\":\"n2\","
+          "\"topo_comp_hash\":\"abc\"}},"
+          "{\"type\":\"Feature\",\"geometry\":{\"type\":\"Point\","
+          "\"coordinates\":[5,5]},\"properties\":{\"id\":\"n3\"}},"
+          "{\"type\":\"Feature\",\"geometry\":{\"type\":\"LineString\","
+          "\"coordinates\":[[0,0],[0,1]]},\"properties\":{\"from\":\"n1\","
+          "\"to\":\"n2\",\"id\":\"e1\",\"topo_comp_hash\":\"abc\","
+          "\"lines\":[{\"id\":\"1\",\"direction\":\"n2\"}]}}]}";
+
+    topo::CompCache cache;
+    cache.read(&ss);
+
+    assert(cache.size() == 1);
+    assert(!cache.get("xyz"));
+    assert(cache.get("abc"));
+    assert(cache.get("abc")->size() == 3);
+
+    auto n1 = nlohmann::json::parse((*cache.get("abc"))[0]);
+    auto n2 = nlohmann::json::parse((*cache.get("abc"))[1]);
+    auto e1 = nlohmann::json::parse((*cache.get("abc"))[2]);
+
+    assert(n1["properties"]["id"] == "abc:0");
+    assert(n2["properties"]["id"] == "abc:1");
+    assert(e1["properties"]["from"] == "abc:0");
+    assert(e1["properties"]["to"] == "abc:1");
+    assert(e1["properties"]["id"] == "abc:2");
+    assert(e1["properties"]["lines"][0]["direction"] == "abc:1");
+    assert(e1["properties"]["lines"][0]["id"] == "1");
+  }
+}
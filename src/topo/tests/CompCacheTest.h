@@ -0,0 +1,12 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#ifndef TOPO_TEST_COMPCACHETEST_H_
+#define TOPO_TEST_COMPCACHETEST_H_
+
+class CompCacheTest {
+  public:
+    void run();
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 
 #include <cassert>
+#include <cmath>
+#include <set>
 #include <string>
 
 #include "shared/linegraph/LineGraph.h"
@@ -156,4 +158,133 @@ void ContractTest2::run() {
 
     mc.combineNodes(b, c);
   }
+
+  // ___________________________________________________________________________
+  {
+    // tiled collapsing should give the same result as sequential collapsing
+    //
+    //  1 ----------------------------------------------------->
+    //  2 ----------------------------------------------------->
+    //
+    shared::linegraph::Line l1("1", "1", "red");
+    shared::linegraph::Line l2("2", "2", "green");
+
+    auto build = [&](shared::linegraph::LineGraph* tg) {
+      for (double y : {0.0, 5.0}) {
+        LineNode* last = 0;
+        for (double x = 0; x <= 3000; x += 100) {
+          auto cur = tg->addNd({{x, y}});
+          if (last) {
+            auto e = tg->addEdg(last, cur, {{{x - 100, y}, {x, y}}});
+            e->pl().addLine(y == 0 ? &l1 : &l2, 0);
+          }
+          last = cur;
+        }
+      }
+    };
+
+    auto check = [&](const shared::linegraph::LineGraph& tg,
+                     const topo::OrigEdgsView& origEdgs, double* len,
+                     size_t* numOrig) {
+      std::set<const LineEdge*> orig;
+      for (auto nd : tg.getNds()) {
+        for (auto e : nd->getAdjList()) {
+          if (e->getFrom() != nd) continue;
+          assert(e->pl().getLines().size() == 2);
+          *len += e->pl().getPolyline().getLength();
+          orig.insert(origEdgs.at(e).begin(), origEdgs.at(e).end());
+        }
+      }
+      *numOrig = orig.size();
+    };
+
+    topo::config::TopoConfig cfg;
+
+    shared::linegraph::LineGraph tgSeq;
+    build(&tgSeq);
+    topo::MapConstructor mcSeq(&cfg, &tgSeq);
+    mcSeq.freeze();
+    mcSeq.collapseShrdSegs(50, 50, 5);
+
+    shared::linegraph::LineGraph tgTiled;
+    build(&tgTiled);
+    topo::MapConstructor mcTiled(&cfg, &tgTiled);
+    mcTiled.freeze();
+    mcTiled.collapseShrdSegsTiled(50, 50, 5, 1000);
+
+    double lenSeq = 0, lenTiled = 0;
+    size_t origSeq = 0, origTiled = 0;
+    check(tgSeq, mcSeq.freezeTrack(0), &lenSeq, &origSeq);
+    check(tgTiled, mcTiled.freezeTrack(0), &lenTiled, &origTiled);
+
+    assert(origSeq == 60);
+    assert(origTiled == 60);
+    assert(fabs(lenSeq - lenTiled) < 0.01 * lenSeq);
+  }
+
+  // ___________________________________________________________________________
+  {
+    // the seam pass of the tiled collapsing only handles the edges at the
+    // inner tile borders and the edges next to them
+    //
+    //                  3 -------------->
+    //                  4 -------------->
+    //
+    //  1 ----------------------------------------------------->
+    //  2 ----------------------------------------------------->
+    //
+    shared::linegraph::Line l1("1", "1", "red");
+    shared::linegraph::Line l2("2", "2", "green");
+    shared::linegraph::Line l3("3", "3", "blue");
+    shared::linegraph::Line l4("4", "4", "yellow");
+
+    shared::linegraph::LineGraph tg;
+
+    auto addLine = [&](const shared::linegraph::Line* l, double y,
+                       double xFrom, double xTo) {
+      LineNode* last = 0;
+      for (double x = xFrom; x <= xTo; x += 100) {
+        auto cur = tg.addNd({{x, y}});
+        if (last) {
+          auto e = tg.addEdg(last, cur, {{{x - 100, y}, {x, y}}});
+          e->pl().addLine(l, 0);
+        }
+        last = cur;
+      }
+    };
+
+    addLine(&l1, 0, 0, 3000);
+    addLine(&l2, 5, 0, 3000);
+    addLine(&l3, 500, 1300, 1700);
+    addLine(&l4, 505, 1300, 1700);
+
+    topo::config::TopoConfig cfg;
+    topo::MapConstructor mc(&cfg, &tg);
+    mc.freeze();
+    mc.collapseShrdSegsTiled(50, 50, 5, 1000);
+
+    const auto& st = mc.getTileStats();
+
+    // all edges except the 4 per line at the two inner tile borders are
+    // collapsed inside the tiles
+    assert(st.tileEdgs == 60);
+    assert(!st.seamFallback);
+
+    // lines 3 and 4 are far from the seams and frozen, the seam pass only
+    // sees the 8 border edges and the collapsed edges next to them
+    assert(st.frozenEdgs > 0);
+    assert(st.seamEdgs > 0);
+    assert(st.seamEdgs < st.tileEdgs);
+
+    const auto& origEdgs = mc.freezeTrack(0);
+    std::set<const LineEdge*> orig;
+    for (auto nd : tg.getNds()) {
+      for (auto e : nd->getAdjList()) {
+        if (e->getFrom() != nd) continue;
+        assert(e->pl().getLines().size() == 2);
+        orig.insert(origEdgs.at(e).begin(), origEdgs.at(e).end());
+      }
+    }
+    assert(orig.size() == 68);
+  }
 }
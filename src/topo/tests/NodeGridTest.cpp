@@ -0,0 +1,68 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#include <cassert>
+#include <vector>
+
+#include "topo/mapconstructor/NodeGrid.h"
+#include "topo/tests/NodeGridTest.h"
+#include "util/Misc.h"
+
+using util::geo::DPoint;
+
+// _____________________________________________________________________________
+void NodeGridTest::run() {
+  // ___________________________________________________________________________
+  {
+    int a, b, c;
+    topo::NodeGrid<int*> grid(10);
+
+    grid.add({0, 0}, &a);
+    grid.add({5, 5}, &b);
+    grid.add({-25, 3}, &c);
+    assert(grid.size() == 3);
+
+    std::vector<int*> res;
+    grid.get({0, 0}, 10, &res);
+    assert(res.size() == 2);
+
+    // relocate into another cell
+    grid.move(&a, {-20, 0});
+    res.clear();
+    grid.get({-22, 0}, 5, &res);
+    assert(res.size() == 2);
+
+    // relocate inside the same cell
+    grid.move(&a, {-21, 0});
+    res.clear();
+    grid.get({-22, 0}, 0.5, &res);
+    assert(res.empty());
+    grid.get({-21, 0}, 0.5, &res);
+    assert(res.size() == 1 && res[0] == &a);
+
+    grid.remove(&c);
+    assert(grid.size() == 2);
+    res.clear();
+    grid.get({-22, 0}, 5, &res);
+    assert(res.size() == 1 && res[0] == &a);
+
+    // adding an existing value moves it
+    grid.add({100, 100}, &b);
+    assert(grid.size() == 2);
+    res.clear();
+    grid.get({0, 0}, 10, &res);
+    assert(res.empty());
+
+    grid.clear();
+    assert(grid.size() == 0);
+    res.clear();
+    grid.get({0, 0}, 1000, &res);
+    assert(res.empty());
+
+    grid.load({{DPoint(1, 1), &a}, {DPoint(-1, -1), &b}, {DPoint(50, 0), &c}});
+    assert(grid.size() == 3);
+    res.clear();
+    grid.get({0, 0}, 2, &res);
+    assert(res.size() == 2);
+  }
+}
@@ -0,0 +1,12 @@
+// Copyright 2023
+// Author: Patrick Brosi
+
+#ifndef TOPO_TEST_NODEGRIDTEST_H_
+#define TOPO_TEST_NODEGRIDTEST_H_
+
+class NodeGridTest {
+  public:
+    void run();
+};
+
+#endif
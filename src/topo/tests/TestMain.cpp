@@ -1,8 +1,10 @@
 // Copyright 2016
 // Author: Patrick Brosi
 
+#include "topo/tests/CompCacheTest.h"
 #include "topo/tests/ContractTest.h"
 #include "topo/tests/ContractTest2.h"
+#include "topo/tests/NodeGridTest.h"
 #include "topo/tests/TopologicalTest.h"
 #include "topo/tests/RestrInfTest.h"
 
@@ -16,9 +18,13 @@ int main(int argc, char** argv) {
   ContractTest ct;
   TopologicalTest tt;
   RestrInfTest rt;
+  CompCacheTest cct;
+  NodeGridTest ngt;
 
   rt.run();
   ct2.run();
   ct.run();
   tt.run();
+  cct.run();
+  ngt.run();
 }